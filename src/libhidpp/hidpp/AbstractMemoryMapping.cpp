@@ -22,50 +22,489 @@
 #include <misc/CRC.h>
 #include <misc/Log.h>
 
+#include <algorithm>
+#include <stdexcept>
+
 using namespace HIDPP;
 
 AbstractMemoryMapping::AbstractMemoryMapping (bool write_crc):
-	_write_crc (write_crc)
+	_write_crc (write_crc),
+	_read_window (DefaultReadWindow),
+	_write_window (DefaultWriteWindow),
+	_verify_crc (false),
+	_stats {},
+	_mem_type_count (0),
+	_page_count (0),
+	_streaming (false),
+	_stop_writer (false)
+{
+}
+
+AbstractMemoryMapping::~AbstractMemoryMapping ()
+{
+	if (_writer.joinable ()) {
+		// Too late: the writer may be calling the destroyed subclass
+		Log::error () << "Memory mapping subclass did not call stopStreaming." << std::endl;
+		stopStreaming ();
+	}
+}
+
+void AbstractMemoryMapping::stopStreaming ()
+{
+	if (!_writer.joinable ())
+		return;
+	{
+		std::unique_lock<std::mutex> lock (_queue_mutex);
+		if (!_jobs.empty ())
+			Log::warning () << "Abandoning streamed page writes." << std::endl;
+		_jobs.clear ();
+		_stop_writer = true;
+	}
+	_queue_cond.notify_one ();
+	_writer.join ();
+	_stop_writer = false;
+}
+
+void AbstractMemoryMapping::setReadWindow (unsigned int window)
+{
+	_read_window = window;
+}
+
+unsigned int AbstractMemoryMapping::readWindow () const
+{
+	return _read_window;
+}
+
+void AbstractMemoryMapping::setWriteWindow (unsigned int window)
 {
+	_write_window = window;
+}
+
+unsigned int AbstractMemoryMapping::writeWindow () const
+{
+	return _write_window;
+}
+
+void AbstractMemoryMapping::setVerifyCRC (bool verify)
+{
+	_verify_crc = verify;
+}
+
+bool AbstractMemoryMapping::verifyCRC () const
+{
+	return _verify_crc;
+}
+
+const AbstractMemoryMapping::ReadStatistics &AbstractMemoryMapping::readStatistics () const
+{
+	return _stats;
+}
+
+void AbstractMemoryMapping::resetReadStatistics ()
+{
+	_stats = {};
+}
+
+void AbstractMemoryMapping::setPageLayout (unsigned int mem_type_count,
+					   unsigned int page_count,
+					   std::size_t page_size)
+{
+	if (!_slots.empty ())
+		throw std::logic_error ("page layout must be set before accessing memory");
+	_mem_type_count = mem_type_count;
+	_page_count = page_count;
+	_slots.resize (mem_type_count * page_count);
+	for (std::size_t i = 0; i < _slots.size (); ++i) {
+		_slots[i].address = { static_cast<int> (i / page_count),
+				      static_cast<unsigned int> (i % page_count), 0 };
+		_slots[i].data.reserve (page_size);
+	}
+	_loaded.assign (_slots.size (), false);
+	_dirty.assign (_slots.size (), false);
+}
+
+std::size_t AbstractMemoryMapping::slotIndex (Address address, bool create)
+{
+	if (address.mem_type >= 0 && static_cast<unsigned int> (address.mem_type) < _mem_type_count &&
+	    address.page < _page_count)
+		return address.mem_type * _page_count + address.page;
+	address.offset = 0;
+	auto it = _overflow.find (address);
+	if (it != _overflow.end ())
+		return it->second;
+	if (!create)
+		return NoSlot;
+	std::size_t index = _slots.size ();
+	_slots.push_back ({ address });
+	_loaded.push_back (false);
+	_dirty.push_back (false);
+	_overflow.emplace (address, index);
+	return index;
+}
+
+void AbstractMemoryMapping::prefetch (const std::vector<Address> &addresses)
+{
+	std::vector<Address> missing;
+	std::vector<std::size_t> indexes;
+	for (const Address &address: addresses) {
+		std::size_t index = slotIndex (address, true);
+		if (!_loaded[index] && std::find (indexes.begin (), indexes.end (), index) == indexes.end ()) {
+			missing.push_back (_slots[index].address);
+			indexes.push_back (index);
+		}
+	}
+	if (missing.empty ())
+		return;
+	Log::debug ("memory") << "Prefetching " << missing.size () << " pages" << std::endl;
+	// Lend the slot buffers so that their storage is reused
+	std::vector<std::vector<uint8_t>> data (missing.size ());
+	for (std::size_t i = 0; i < indexes.size (); ++i)
+		data[i].swap (_slots[indexes[i]].data);
+	try {
+		std::unique_lock<std::mutex> lock (_io_mutex);
+		readPages (missing, data);
+	}
+	catch (...) {
+		for (std::size_t i = 0; i < indexes.size (); ++i)
+			data[i].swap (_slots[indexes[i]].data);
+		throw;
+	}
+	for (std::size_t i = 0; i < indexes.size (); ++i) {
+		_stats.pages_read++;
+		verifyPage (missing[i], data[i]);
+		_slots[indexes[i]].data.swap (data[i]);
+		_loaded[indexes[i]] = true;
+	}
+}
+
+void AbstractMemoryMapping::readPages (const std::vector<Address> &addresses, std::vector<std::vector<uint8_t>> &data)
+{
+	for (std::size_t i = 0; i < addresses.size (); ++i)
+		readPage (addresses[i], data[i]);
 }
 
 const std::vector<uint8_t> &AbstractMemoryMapping::getReadOnlyPage (const Address &address)
 {
-	return getPage (address).data;
+	return _slots[loadPage (address)].data;
 }
 
 std::vector<uint8_t> &AbstractMemoryMapping::getWritablePage (const Address &address)
 {
-	auto &page = getPage (address);
-	page.modified = true;
+	std::size_t index = loadPage (address);
+	auto &page = _slots[index];
+	if (!_dirty[index]) {
+		page.original = page.data;
+		_dirty[index] = true;
+	}
+	return page.data;
+}
+
+const std::vector<uint8_t> &AbstractMemoryMapping::getFinalPage (const Address &address)
+{
+	std::size_t index = slotIndex (address, false);
+	if (index == NoSlot || !_dirty[index])
+		throw std::logic_error ("page is not modified");
+	auto &page = _slots[index];
+	writeCRC (page);
 	return page.data;
 }
 
 void AbstractMemoryMapping::sync ()
 {
-	for (auto &p: _pages) {
-		auto &address = p.first;
-		auto &page = p.second;
-		if (page.modified) {
-			if (_write_crc) {
-				uint16_t crc = CRC::CCITT (page.data.begin (),
-							   page.data.end () - sizeof (crc));
-				writeBE (page.data.end () - sizeof (crc), crc);
-			}
-			writePage (address, page.data);
-			page.modified = false;
+	syncPages (nullptr);
+}
+
+unsigned int AbstractMemoryMapping::syncVerified ()
+{
+	auto debug = Log::debug ("memory");
+	std::vector<std::size_t> written;
+	syncPages (&written);
+	std::sort (written.begin (), written.end ());
+	written.erase (std::unique (written.begin (), written.end ()), written.end ());
+
+	unsigned int rewritten = 0;
+	for (std::size_t index: written) {
+		const auto &page = _slots[index];
+		if (checkLastLine (page))
+			continue;
+		debug.printf ("Page %d/%u failed verification, reading it again\n",
+			      page.address.mem_type, page.address.page);
+		std::unique_lock<std::mutex> lock (_io_mutex);
+		std::vector<uint8_t> current;
+		readPage (page.address, current);
+		if (current != page.data) {
+			writePage (page.address, page.data);
+			lock.unlock ();
+			++rewritten;
+			if (!checkLastLine (page))
+				throw std::runtime_error ("Memory page verification failed after rewriting");
 		}
 	}
+	return rewritten;
 }
 
-AbstractMemoryMapping::Page &AbstractMemoryMapping::getPage (Address address)
+bool AbstractMemoryMapping::checkLastLine (const Page &page)
 {
-	address.offset = 0;
-	auto it = _pages.find (address);
-	if (it == _pages.end ()) {
-		it = _pages.emplace (address, Page { false }).first;
-		readPage (address, it->second.data);
+	const std::size_t size = page.data.size ();
+	const std::size_t begin = size - std::min (size, lineSize ());
+	std::vector<uint8_t> readback (size);
+	std::unique_lock<std::mutex> lock (_io_mutex);
+	readPageRanges (page.address, readback, { { begin, size } });
+	return std::equal (readback.begin () + begin, readback.end (), page.data.begin () + begin);
+}
+
+void AbstractMemoryMapping::syncPages (std::vector<std::size_t> *written)
+{
+	finishStreaming ();
+	if (written)
+		written->insert (written->end (), _streamed.begin (), _streamed.end ());
+	_streamed.clear ();
+
+	for (std::size_t index = 0; index < _slots.size (); ++index) {
+		std::vector<Range> ranges;
+		if (!_dirty[index] || !prepareWrite (index, ranges))
+			continue;
+		{
+			std::unique_lock<std::mutex> lock (_io_mutex);
+			writePageRanges (_slots[index].address, _slots[index].data, ranges);
+		}
+		if (written)
+			written->push_back (index);
 	}
-	return it->second;
 }
 
+void AbstractMemoryMapping::writeCRC (Page &page) const
+{
+	if (_write_crc) {
+		uint16_t crc = CRC::CCITT (page.data.begin (),
+					   page.data.end () - sizeof (crc));
+		writeBE (page.data.end () - sizeof (crc), crc);
+	}
+}
+
+bool AbstractMemoryMapping::prepareWrite (std::size_t index, std::vector<Range> &ranges)
+{
+	auto &page = _slots[index];
+	writeCRC (page);
+	ranges = modifiedRanges (page);
+	_dirty[index] = false;
+	page.original.clear ();
+	if (ranges.empty ()) {
+		Log::debug ("memory").printf ("Page %d/%u is unchanged, skipping it\n",
+					      page.address.mem_type, page.address.page);
+		return false;
+	}
+	return true;
+}
+
+void AbstractMemoryMapping::commitPage (const Address &address)
+{
+	std::size_t index = slotIndex (address, false);
+	if (index == NoSlot || !_dirty[index])
+		return;
+	if (_streaming) {
+		// Do not write pages after a failed one, they may refer to it
+		std::unique_lock<std::mutex> lock (_queue_mutex);
+		if (_writer_error)
+			std::rethrow_exception (_writer_error);
+	}
+	std::vector<Range> ranges;
+	if (!prepareWrite (index, ranges))
+		return;
+	auto &page = _slots[index];
+	if (!_streaming) {
+		std::unique_lock<std::mutex> lock (_io_mutex);
+		writePageRanges (page.address, page.data, ranges);
+		_streamed.push_back (index);
+		return;
+	}
+	{
+		std::unique_lock<std::mutex> lock (_queue_mutex);
+		_jobs.push_back ({ index, page.address, page.data, std::move (ranges) });
+	}
+	if (!_writer.joinable ())
+		_writer = std::thread (&AbstractMemoryMapping::writerLoop, this);
+	_queue_cond.notify_one ();
+}
+
+void AbstractMemoryMapping::setStreamingWrites (bool streaming)
+{
+	if (!streaming)
+		finishStreaming ();
+	_streaming = streaming;
+}
+
+bool AbstractMemoryMapping::streamingWrites () const
+{
+	return _streaming;
+}
+
+void AbstractMemoryMapping::writerLoop ()
+{
+	std::unique_lock<std::mutex> lock (_queue_mutex);
+	while (true) {
+		_queue_cond.wait (lock, [this] () { return _stop_writer || !_jobs.empty (); });
+		if (_writer_error)
+			_jobs.clear ();
+		if (_jobs.empty ()) {
+			if (_stop_writer)
+				return;
+			continue;
+		}
+		WriteJob job = std::move (_jobs.front ());
+		_jobs.pop_front ();
+		lock.unlock ();
+		try {
+			std::unique_lock<std::mutex> io_lock (_io_mutex);
+			writePageRanges (job.address, job.data, job.ranges);
+		}
+		catch (...) {
+			lock.lock ();
+			if (!_writer_error)
+				_writer_error = std::current_exception ();
+			_jobs.clear ();
+			continue;
+		}
+		lock.lock ();
+		_streamed.push_back (job.index);
+	}
+}
+
+void AbstractMemoryMapping::finishStreaming ()
+{
+	if (_writer.joinable ()) {
+		{
+			std::unique_lock<std::mutex> lock (_queue_mutex);
+			_stop_writer = true;
+		}
+		_queue_cond.notify_one ();
+		_writer.join ();
+		_stop_writer = false;
+	}
+	if (_writer_error) {
+		auto error = _writer_error;
+		_writer_error = nullptr;
+		std::rethrow_exception (error);
+	}
+}
+
+std::size_t AbstractMemoryMapping::lineSize () const
+{
+	return 16;
+}
+
+void AbstractMemoryMapping::writePageRanges (const Address &address, const std::vector<uint8_t> &data,
+					     const std::vector<Range> &)
+{
+	writePage (address, data);
+}
+
+std::vector<AbstractMemoryMapping::Range> AbstractMemoryMapping::modifiedRanges (const Page &page) const
+{
+	std::vector<Range> ranges;
+	if (page.original.size () != page.data.size ()) {
+		ranges.emplace_back (0, page.data.size ());
+		return ranges;
+	}
+	const std::size_t line_size = lineSize ();
+	for (std::size_t begin = 0; begin < page.data.size (); begin += line_size) {
+		std::size_t end = std::min (begin + line_size, page.data.size ());
+		if (std::equal (page.data.begin () + begin, page.data.begin () + end,
+				page.original.begin () + begin))
+			continue;
+		if (!ranges.empty () && ranges.back ().second == begin)
+			ranges.back ().second = end; // extend the previous range
+		else
+			ranges.emplace_back (begin, end);
+	}
+	return ranges;
+}
+
+std::size_t AbstractMemoryMapping::loadPage (const Address &address)
+{
+	std::size_t index = slotIndex (address, true);
+	if (!_loaded[index]) {
+		auto &page = _slots[index];
+		{
+			std::unique_lock<std::mutex> lock (_io_mutex);
+			readPage (page.address, page.data);
+		}
+		_stats.pages_read++;
+		verifyPage (page.address, page.data);
+		_loaded[index] = true;
+	}
+	return index;
+}
+
+void AbstractMemoryMapping::readPageRanges (const Address &address, std::vector<uint8_t> &data,
+					    const std::vector<Range> &ranges)
+{
+	std::vector<uint8_t> page;
+	readPage (address, page);
+	for (const auto &range: ranges)
+		std::copy (page.begin () + range.first, page.begin () + range.second,
+			   data.begin () + range.first);
+}
+
+bool AbstractMemoryMapping::checkCRC (const std::vector<uint8_t> &data) const
+{
+	if (data.size () < sizeof (uint16_t))
+		return false;
+	uint16_t crc = CRC::CCITT (data.begin (), data.end () - sizeof (uint16_t));
+	return crc == readBE<uint16_t> (data.end () - sizeof (uint16_t));
+}
+
+void AbstractMemoryMapping::verifyPage (const Address &address, std::vector<uint8_t> &data)
+{
+	if (!_write_crc || !_verify_crc || checkCRC (data))
+		return;
+
+	auto debug = Log::debug ("memory");
+	debug.printf ("Page %d/%u has a wrong CRC, reading it again\n",
+		      address.mem_type, address.page);
+	_stats.crc_failures++;
+
+	// Read the whole page again and find the lines that changed
+	const std::size_t line_size = lineSize ();
+	std::vector<Range> all_lines;
+	for (std::size_t begin = 0; begin < data.size (); begin += line_size)
+		all_lines.emplace_back (begin, std::min (begin + line_size, data.size ()));
+	std::vector<uint8_t> previous = data;
+	{
+		std::unique_lock<std::mutex> lock (_io_mutex);
+		readPageRanges (address, data, all_lines);
+	}
+	_stats.page_rereads++;
+
+	auto unstableLines = [&data, &previous] (const std::vector<Range> &lines) {
+		std::vector<Range> unstable;
+		for (const auto &line: lines)
+			if (!std::equal (data.begin () + line.first, data.begin () + line.second,
+					 previous.begin () + line.first))
+				unstable.push_back (line);
+		return unstable;
+	};
+	auto unstable = unstableLines (all_lines);
+	unsigned int rereads = 0;
+	while (!unstable.empty () && !checkCRC (data)) {
+		if (rereads++ == MaxLineRereads)
+			throw std::runtime_error ("Unstable memory read with invalid CRC");
+		debug.printf ("Reading %zu unstable lines again\n", unstable.size ());
+		previous = data;
+		{
+			std::unique_lock<std::mutex> lock (_io_mutex);
+			readPageRanges (address, data, unstable);
+		}
+		_stats.lines_reread += unstable.size ();
+		unstable = unstableLines (unstable);
+	}
+
+	if (checkCRC (data)) {
+		debug.printf ("Page %d/%u recovered\n", address.mem_type, address.page);
+		_stats.recovered_pages++;
+	}
+	else {
+		Log::warning ().printf ("Page %d/%u has a wrong CRC\n", address.mem_type, address.page);
+		_stats.bad_crc_pages++;
+	}
+}
@@ -21,7 +21,13 @@
 
 #include <hidpp/Address.h>
 #include <vector>
+#include <condition_variable>
+#include <deque>
+#include <exception>
 #include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
 #include <cstdint>
 
 namespace HIDPP
@@ -39,6 +45,7 @@ class AbstractMemoryMapping
 {
 public:
 	AbstractMemoryMapping (bool write_crc = true);
+	virtual ~AbstractMemoryMapping ();
 
 	/**
 	 * Get the page at \p address (offset is ignored) as read-only.
@@ -48,11 +55,116 @@ public:
 	 * Get the page at \p address (offset is ignored) and mark it as "modified".
 	 */
 	std::vector<uint8_t> &getWritablePage (const Address &address);
+	/**
+	 * Get the page at \p address as it will be written by sync, with
+	 * its CRC when \p write_crc is used. The page must have been
+	 * modified and stays modified.
+	 */
+	const std::vector<uint8_t> &getFinalPage (const Address &address);
 
 	/**
 	 * Write all modified pages to the device memory.
+	 *
+	 * Modified pages are compared with their content when they were
+	 * first made writable: only the changed lines are written (see
+	 * writePageRanges) and pages whose final content is unchanged are
+	 * skipped.
 	 */
 	void sync ();
+	/**
+	 * Same as sync but check every written page by reading back only its
+	 * last line, which contains the CRC when \p write_crc is used.
+	 *
+	 * A page whose last line does not match is read entirely and
+	 * written again if it differs.
+	 *
+	 * \returns the number of pages that were written again.
+	 * \throws std::runtime_error if a page still does not match after
+	 * being written again.
+	 */
+	unsigned int syncVerified ();
+
+	/**
+	 * Declare that the page at \p address is final until the next sync.
+	 *
+	 * Its CRC is computed and its modified lines are written, either
+	 * immediately or, with streaming writes enabled, by a background
+	 * thread while the caller keeps encoding other pages. Device
+	 * accesses from both threads are serialized, so pages can still be
+	 * read meanwhile. sync() waits for the background writes and
+	 * rethrows their errors.
+	 *
+	 * Once a background write failed, no other page is written: the
+	 * pending pages are dropped and commitPage throws the write error
+	 * until sync() is called.
+	 */
+	void commitPage (const Address &address);
+	void setStreamingWrites (bool streaming);
+	bool streamingWrites () const;
+
+	/**
+	 * Default number of read requests kept in flight by readPage:
+	 * requests are strictly sequential.
+	 */
+	static constexpr unsigned int DefaultReadWindow = 1;
+	/**
+	 * Set the maximum number of read requests that are sent without
+	 * waiting for the previous responses when reading a page.
+	 *
+	 * Larger windows rely on the device answering queued requests in
+	 * order, they are only used when explicitly requested.
+	 */
+	void setReadWindow (unsigned int window);
+	unsigned int readWindow () const;
+
+	/**
+	 * Default number of unacknowledged write packets allowed by
+	 * writePage: every packet is acknowledged before the next one.
+	 */
+	static constexpr unsigned int DefaultWriteWindow = 1;
+	/**
+	 * Set the maximum number of data packets sent without waiting for
+	 * their acknowledgements when writing a page, for mappings that
+	 * support it.
+	 *
+	 * Larger windows are faster but untested on most devices, they are
+	 * only used when explicitly requested.
+	 */
+	void setWriteWindow (unsigned int window);
+	unsigned int writeWindow () const;
+
+	/**
+	 * Check the CRC of every page read when the mapping was created
+	 * with \p write_crc.
+	 *
+	 * When the CRC does not match, the page is read again and only the
+	 * lines that changed between the two reads are re-read, until they
+	 * are stable or MaxLineRereads is reached. A page with a stable but
+	 * wrong CRC (e.g. unused memory) is kept and a warning is logged,
+	 * a page whose lines never stabilize throws std::runtime_error.
+	 */
+	void setVerifyCRC (bool verify);
+	bool verifyCRC () const;
+
+	static constexpr unsigned int MaxLineRereads = 3;
+
+	struct ReadStatistics
+	{
+		unsigned int pages_read;	///< Pages read from the device.
+		unsigned int crc_failures;	///< Pages whose first read had a wrong CRC.
+		unsigned int page_rereads;	///< Whole pages read again after a CRC failure.
+		unsigned int lines_reread;	///< Lines read again because they were unstable.
+		unsigned int recovered_pages;	///< Pages whose CRC matched after re-reading.
+		unsigned int bad_crc_pages;	///< Pages kept with a stable but wrong CRC.
+	};
+	const ReadStatistics &readStatistics () const;
+	void resetReadStatistics ();
+
+	/**
+	 * Read every page in \p addresses (offsets are ignored) that is not
+	 * already cached, in a single batch.
+	 */
+	void prefetch (const std::vector<Address> &addresses);
 
 	/**
 	 * Get a read-only iterator to the position corresponding
@@ -81,22 +193,124 @@ public:
 protected:
 	/**
 	 * Read the page at \p address and fill data.
+	 *
+	 * Implementation should keep up to readWindow() requests in flight.
 	 */
 	virtual void readPage (const Address &address, std::vector<uint8_t> &data) = 0;
+	/**
+	 * Read the pages at \p addresses and fill the corresponding element of
+	 * \p data.
+	 *
+	 * The default implementation calls readPage for each page,
+	 * implementation should override it for pipelining requests across
+	 * pages.
+	 */
+	virtual void readPages (const std::vector<Address> &addresses, std::vector<std::vector<uint8_t>> &data);
 	/**
 	 * Write the data in \p data in page at \p address.
 	 */
 	virtual void writePage (const Address &address, const std::vector<uint8_t> &data) = 0;
 
+	/**
+	 * Preallocate the page cache for \p mem_type_count memory types of
+	 * \p page_count pages of \p page_size bytes.
+	 *
+	 * Pages in this layout are found by direct indexing, other
+	 * addresses use a slower associative lookup. Must be called before
+	 * any page is accessed, usually from the subclass constructor.
+	 */
+	void setPageLayout (unsigned int mem_type_count, unsigned int page_count,
+			    std::size_t page_size);
+
+	/**
+	 * Stop the streaming writer thread, abandoning the pending writes
+	 * (call sync() for completing them).
+	 *
+	 * The writer thread calls the virtual write methods, every subclass
+	 * must call this from its destructor so that the thread is stopped
+	 * before the subclass is destroyed.
+	 */
+	void stopStreaming ();
+
+	/**
+	 * Byte range [first, second) in a page.
+	 */
+	typedef std::pair<std::size_t, std::size_t> Range;
+	/**
+	 * Granularity used when comparing modified pages, ranges passed to
+	 * writePageRanges are aligned on this size (except at the page end).
+	 */
+	virtual std::size_t lineSize () const;
+	/**
+	 * Write only the ranges \p ranges of the page at \p address.
+	 *
+	 * \p data contains the whole page. The default implementation
+	 * calls writePage.
+	 */
+	virtual void writePageRanges (const Address &address, const std::vector<uint8_t> &data,
+				      const std::vector<Range> &ranges);
+	/**
+	 * Read only the ranges \p ranges of the page at \p address into the
+	 * corresponding bytes of \p data.
+	 *
+	 * The default implementation reads the whole page with readPage.
+	 */
+	virtual void readPageRanges (const Address &address, std::vector<uint8_t> &data,
+				     const std::vector<Range> &ranges);
+
 private:
 	bool _write_crc;
+	unsigned int _read_window;
+	unsigned int _write_window;
+	bool _verify_crc;
+	ReadStatistics _stats;
 	struct Page {
-		bool modified;
+		Address address;
+		std::vector<uint8_t> data;
+		std::vector<uint8_t> original; ///< Content before the page was modified.
+	};
+	/*
+	 * Page cache: the pages from the layout set by setPageLayout come
+	 * first, indexed by memory type and page, followed by pages at
+	 * other addresses found through _overflow. A deque keeps page
+	 * references valid when adding pages.
+	 */
+	std::deque<Page> _slots;
+	std::vector<bool> _loaded;
+	std::vector<bool> _dirty;
+	unsigned int _mem_type_count;
+	unsigned int _page_count;
+	std::map<Address, std::size_t> _overflow;
+
+	static constexpr std::size_t NoSlot = static_cast<std::size_t> (-1);
+	std::size_t slotIndex (Address address, bool create);
+	std::size_t loadPage (const Address &address);
+	void syncPages (std::vector<std::size_t> *written);
+
+	struct WriteJob {
+		std::size_t index;
+		Address address;
 		std::vector<uint8_t> data;
+		std::vector<Range> ranges;
 	};
-	std::map<Address, Page> _pages;
+	void writeCRC (Page &page) const;
+	bool prepareWrite (std::size_t index, std::vector<Range> &ranges);
+	void writerLoop ();
+	void finishStreaming ();
 
-	Page &getPage (Address address);
+	bool _streaming;
+	std::mutex _io_mutex; ///< Serializes device accesses with the writer thread.
+	std::mutex _queue_mutex;
+	std::condition_variable _queue_cond;
+	std::deque<WriteJob> _jobs;
+	bool _stop_writer;
+	std::exception_ptr _writer_error;
+	std::vector<std::size_t> _streamed; ///< Pages written by the writer thread.
+	std::thread _writer;
+	bool checkLastLine (const Page &page);
+	std::vector<Range> modifiedRanges (const Page &page) const;
+	bool checkCRC (const std::vector<uint8_t> &data) const;
+	void verifyPage (const Address &address, std::vector<uint8_t> &data);
 };
 
 }
@@ -35,8 +35,11 @@ public:
 	/**
 	 * Access the complete list of settings and their names used
 	 * by this format.
+	 *
+	 * ProfileDirectory::Entry::settings is indexed by this schema. It stays
+	 * valid as long as the format.
 	 */
-	virtual const std::map<std::string, SettingDesc> &settings () const = 0;
+	virtual SettingSchema settings () const = 0;
 
 	/**
 	 * Read the profile directory beginning at \p begin.
@@ -55,12 +55,18 @@ public:
 
 	/**
 	 * The list of settings and their names used by the whole profile.
+	 *
+	 * Profile::settings is indexed by this schema. It stays valid as long
+	 * as the format.
 	 */
-	virtual const std::map<std::string, SettingDesc> &generalSettings () const = 0;
+	virtual SettingSchema generalSettings () const = 0;
 	/**
 	 * The list of settings and their names used by each mode.
+	 *
+	 * Profile::modes elements are indexed by this schema. It stays valid
+	 * as long as the format.
 	 */
-	virtual const std::map<std::string, SettingDesc> &modeSettings () const = 0;
+	virtual SettingSchema modeSettings () const = 0;
 	/**
 	 * The list of special actions that can be mapped to buttons
 	 */
@@ -0,0 +1,63 @@
+/*
+ * Copyright 2026 Clément Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "CommandPipeline.h"
+
+#include <hidpp/Dispatcher.h>
+#include <misc/Log.h>
+
+#include <deque>
+
+using namespace HIDPP;
+
+static constexpr int DrainTimeout = 500; // ms
+
+void HIDPP::sendPipelinedCommands (Dispatcher *dispatcher, unsigned int window,
+				   std::size_t count,
+				   const std::function<Report (std::size_t)> &build_request,
+				   const std::function<void (std::size_t, Report &&)> &handle_response)
+{
+	if (window == 0)
+		window = 1;
+	std::deque<std::unique_ptr<Dispatcher::AsyncReport>> in_flight;
+	std::size_t sent = 0, received = 0;
+	try {
+		while (received < count) {
+			while (sent < count && in_flight.size () < window) {
+				in_flight.push_back (dispatcher->sendCommand (build_request (sent)));
+				++sent;
+			}
+			auto response = in_flight.front ()->get ();
+			in_flight.pop_front ();
+			handle_response (received, std::move (response));
+			++received;
+		}
+	}
+	catch (...) {
+		for (auto &command: in_flight) {
+			try {
+				command->get (DrainTimeout);
+			}
+			catch (std::exception &e) {
+				Log::debug ("dispatcher") << "Ignored error while draining pipelined commands: " << e.what () << std::endl;
+			}
+		}
+		throw;
+	}
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright 2026 Clément Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef LIBHIDPP_HIDPP_COMMAND_PIPELINE_H
+#define LIBHIDPP_HIDPP_COMMAND_PIPELINE_H
+
+#include <hidpp/Report.h>
+#include <functional>
+
+namespace HIDPP
+{
+
+class Dispatcher;
+
+/**
+ * Send \p count commands keeping up to \p window of them in flight.
+ *
+ * \p build_request is called with the index of each command just before
+ * it is sent, \p handle_response receives the responses in the same
+ * order as the commands were built. Devices answer commands in the order
+ * they are received, so this is safe with both SimpleDispatcher and
+ * DispatcherThread.
+ *
+ * If a command fails, the remaining commands in flight are drained
+ * before the exception is rethrown, so that their late responses are not
+ * mistaken for the responses of the next commands.
+ *
+ * A \p window of 1 (or 0) is equivalent to sending the commands one at a
+ * time.
+ *
+ * \ingroup hidpp
+ */
+void sendPipelinedCommands (Dispatcher *dispatcher, unsigned int window,
+			    std::size_t count,
+			    const std::function<Report (std::size_t)> &build_request,
+			    const std::function<void (std::size_t, Report &&)> &handle_response);
+
+}
+
+#endif
@@ -0,0 +1,205 @@
+/*
+ * Copyright 2026 Clément Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DeviceProbe.h"
+
+#include <hidpp/DispatcherThread.h>
+#include <hidpp10/Device.h>
+#include <hidpp10/IReceiver.h>
+#include <hidpp10/Error.h>
+#include <hidpp20/Error.h>
+#include <hidpp20/IRoot.h>
+#include <misc/Log.h>
+
+#include <cassert>
+#include <future>
+#include <thread>
+
+using namespace HIDPP;
+
+typedef std::chrono::steady_clock::time_point time_point;
+
+// Same timeout as the one used by Device for corded devices.
+static constexpr std::chrono::milliseconds CordedTimeout (500);
+
+namespace
+{
+
+struct PendingPing
+{
+	ProbedDevice device;
+	std::unique_ptr<Dispatcher::AsyncReport> response;
+};
+
+}
+
+static int remainingTime (time_point deadline)
+{
+	auto remaining = std::chrono::duration_cast<std::chrono::milliseconds> (
+			deadline - std::chrono::steady_clock::now ());
+	return std::max (0, static_cast<int> (remaining.count ()));
+}
+
+static PendingPing sendPing (Dispatcher *dispatcher, ProbedDevice &&device)
+{
+	static constexpr unsigned int software_id = 1;
+	auto type = dispatcher->reportInfo ().findReport ();
+	assert (type);
+	Report request (*type, device.index, HIDPP20::IRoot::index, HIDPP20::IRoot::Ping, software_id);
+	return PendingPing { std::move (device), dispatcher->sendCommand (std::move (request)) };
+}
+
+/*
+ * Wait for the ping answer and fill the protocol version.
+ *
+ * Returns false if the index does not have any device or did not answer in time.
+ */
+static bool waitPing (PendingPing &ping, time_point deadline)
+{
+	const char *path = ping.device.path.c_str ();
+	int index = ping.device.index;
+	try {
+		auto report = ping.response->get (remainingTime (deadline));
+		auto params = report.parameterBegin ();
+		ping.device.version = std::make_tuple (params[0], params[1]);
+		return true;
+	}
+	catch (HIDPP10::Error &e) {
+		// Valid HID++1.0 devices should send a "Invalid SubID" error.
+		if (e.errorCode () == HIDPP10::Error::InvalidSubID) {
+			ping.device.version = std::make_tuple (1, 0);
+			return true;
+		}
+		if (e.errorCode () != HIDPP10::Error::UnknownDevice)
+			Log::error ().printf ("Error while querying %s device %d: %s\n",
+					      path, index, e.what ());
+	}
+	catch (HIDPP20::Error &e) {
+		if (e.errorCode () != HIDPP20::Error::UnknownDevice)
+			Log::error ().printf ("Error while querying %s device %d: %s\n",
+					      path, index, e.what ());
+	}
+	catch (Dispatcher::TimeoutError &e) {
+		Log::warning ().printf ("Device %s (index %d) timed out\n", path, index);
+	}
+	return false;
+}
+
+static std::vector<ProbedDevice> probe (Dispatcher *dispatcher, const std::string &path, time_point deadline)
+{
+	std::vector<ProbedDevice> devices;
+	auto local_device = [dispatcher, &path] (DeviceIndex index) {
+		return ProbedDevice {
+			path, index,
+			dispatcher->vendorID (), dispatcher->productID (), dispatcher->name (),
+			std::make_tuple (0, 0)
+		};
+	};
+
+	// Corded or receiver indexes answer quickly, do not wait for the full deadline.
+	auto corded_deadline = std::min (deadline, std::chrono::steady_clock::now () + CordedTimeout);
+	std::vector<PendingPing> pings;
+	pings.push_back (sendPing (dispatcher, local_device (DefaultDevice)));
+	pings.push_back (sendPing (dispatcher, local_device (CordedDevice)));
+	bool is_receiver = false;
+	for (auto &ping: pings) {
+		if (waitPing (ping, corded_deadline)) {
+			if (ping.device.index == DefaultDevice && ping.device.version == std::make_tuple (1, 0))
+				is_receiver = true;
+			devices.push_back (std::move (ping.device));
+		}
+	}
+	if (!is_receiver)
+		return devices;
+
+	// Only ping slots the receiver knows about, all at once.
+	pings.clear ();
+	{
+		HIDPP10::Device receiver (dispatcher, DefaultDevice);
+		HIDPP10::IReceiver ireceiver (&receiver);
+		for (DeviceIndex index: {
+				WirelessDevice1, WirelessDevice2, WirelessDevice3,
+				WirelessDevice4, WirelessDevice5, WirelessDevice6 }) {
+			ProbedDevice device = local_device (index);
+			try {
+				ireceiver.getDeviceInformation (index - 1,
+								nullptr,
+								nullptr,
+								&device.product_id,
+								nullptr);
+				device.name = ireceiver.getDeviceName (index - 1);
+			}
+			catch (HIDPP10::Error &e) {
+				// the invalid value is the device index
+				if (e.errorCode () != HIDPP10::Error::InvalidValue &&
+				    e.errorCode () != HIDPP10::Error::UnknownDevice)
+					Log::error ().printf ("Error while asking %s for device %d infos: %s\n",
+							      path.c_str (), index, e.what ());
+				continue;
+			}
+			pings.push_back (sendPing (dispatcher, std::move (device)));
+		}
+	}
+	for (auto &ping: pings) {
+		if (waitPing (ping, deadline))
+			devices.push_back (std::move (ping.device));
+	}
+	return devices;
+}
+
+std::vector<ProbedDevice> HIDPP::probeDevices (Dispatcher *dispatcher, time_point deadline)
+{
+	return probe (dispatcher, std::string (), deadline);
+}
+
+static std::vector<ProbedDevice> probeNode (const std::string &path, time_point deadline)
+{
+	std::vector<ProbedDevice> devices;
+	try {
+		DispatcherThread dispatcher (path.c_str ());
+		std::thread thread (std::bind (&DispatcherThread::run, &dispatcher));
+		try {
+			devices = probe (&dispatcher, path, deadline);
+		}
+		catch (std::exception &e) {
+			Log::error ().printf ("Error while probing %s: %s\n", path.c_str (), e.what ());
+		}
+		dispatcher.stop ();
+		thread.join ();
+	}
+	catch (Dispatcher::NoHIDPPReportException &e) {
+	}
+	catch (std::system_error &e) {
+		Log::warning ().printf ("Failed to open %s: %s\n", path.c_str (), e.what ());
+	}
+	return devices;
+}
+
+std::vector<ProbedDevice> HIDPP::probeDevices (const std::vector<std::string> &paths, int timeout)
+{
+	auto deadline = std::chrono::steady_clock::now () + std::chrono::milliseconds (timeout);
+	std::vector<std::future<std::vector<ProbedDevice>>> probes;
+	for (const auto &path: paths)
+		probes.push_back (std::async (std::launch::async, probeNode, path, deadline));
+	std::vector<ProbedDevice> devices;
+	for (auto &probe: probes) {
+		auto node_devices = probe.get ();
+		std::move (node_devices.begin (), node_devices.end (), std::back_inserter (devices));
+	}
+	return devices;
+}
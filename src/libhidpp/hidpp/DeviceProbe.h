@@ -0,0 +1,78 @@
+/*
+ * Copyright 2026 Clément Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef LIBHIDPP_HIDPP_DEVICE_PROBE_H
+#define LIBHIDPP_HIDPP_DEVICE_PROBE_H
+
+#include <hidpp/defs.h>
+#include <chrono>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace HIDPP
+{
+
+class Dispatcher;
+
+/**
+ * Result of probing one device index on a HID++ node.
+ *
+ * \ingroup hidpp
+ */
+struct ProbedDevice
+{
+	std::string path;	///< Node path, empty when probing a dispatcher directly.
+	DeviceIndex index;
+	uint16_t vendor_id;
+	uint16_t product_id;
+	std::string name;
+	std::tuple<unsigned int, unsigned int> version;
+};
+
+/**
+ * Probe every device index of the node used by \p dispatcher.
+ *
+ * The pings for DefaultDevice and CordedDevice are sent together. When
+ * DefaultDevice is a HID++ 1.0 receiver, its pairing information is read
+ * first and only paired slots are pinged, all at the same time. Every
+ * ping shares the same \p deadline, so sleeping devices cost a single
+ * timeout instead of one per slot.
+ *
+ * \p dispatcher must accept several commands at once (e.g. a
+ * DispatcherThread with its run loop running in another thread).
+ *
+ * Errors for single indexes are logged and the index is skipped.
+ */
+std::vector<ProbedDevice> probeDevices (Dispatcher *dispatcher,
+					std::chrono::steady_clock::time_point deadline);
+
+/**
+ * Open and probe each node in \p paths in parallel.
+ *
+ * Every node is probed in its own thread using a DispatcherThread and
+ * all of them share the same deadline: \p timeout milliseconds from now.
+ * Nodes that cannot be opened or are not HID++ are skipped.
+ *
+ * \returns devices sorted in the same order as \p paths.
+ */
+std::vector<ProbedDevice> probeDevices (const std::vector<std::string> &paths, int timeout = 2000);
+
+}
+
+#endif
@@ -81,7 +81,7 @@ bool EnumDesc::check (int value) const
 }
 
 EnumValue::EnumValue (const EnumDesc &desc, int value):
-	_desc (desc),
+	_desc (&desc),
 	_value (value)
 {
 }
@@ -98,11 +98,11 @@ void EnumValue::set (int value)
 
 std::string EnumValue::toString () const
 {
-	return _desc.toString (_value);
+	return _desc->toString (_value);
 }
 
 
 const EnumDesc &EnumValue::desc () const
 {
-	return _desc;
+	return *_desc;
 }
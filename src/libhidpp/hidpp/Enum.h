@@ -70,7 +70,7 @@ public:
 	const EnumDesc &desc () const;
 
 private:
-	const EnumDesc &_desc;
+	const EnumDesc *_desc;
 	int _value;
 };
 
@@ -19,8 +19,12 @@
 #ifndef LIBHIDPP_HIDPP_FIELD_H
 #define LIBHIDPP_HIDPP_FIELD_H
 
+#include <hidpp/Setting.h>
 #include <misc/Endian.h>
 
+#include <array>
+#include <vector>
+
 namespace HIDPP
 {
 
@@ -38,6 +42,7 @@ template<typename T>
 class Field<T, Undefined>
 {
 public:
+	typedef T value_type;
 	unsigned int offset;
 	static constexpr std::size_t size = sizeof (T);
 
@@ -63,6 +68,7 @@ template<typename T>
 class Field<T, BigEndian>
 {
 public:
+	typedef T value_type;
 	unsigned int offset;
 	static constexpr std::size_t size = sizeof (T);
 
@@ -86,6 +92,7 @@ template<typename T>
 class Field<T, LittleEndian>
 {
 public:
+	typedef T value_type;
 	unsigned int offset;
 	static constexpr std::size_t size = sizeof (T);
 
@@ -109,6 +116,7 @@ template<>
 class Field<Color, Undefined>
 {
 public:
+	typedef Color value_type;
 	unsigned int offset;
 	static constexpr std::size_t size = sizeof (Color);
 
@@ -134,6 +142,7 @@ template<typename T, std::size_t Count, ByteOrder BO = Undefined>
 class ArrayField
 {
 public:
+	typedef std::array<T, Count> value_type;
 	unsigned int offset;
 	static constexpr std::size_t size = Count * sizeof (T);
 	typedef Field<T, BO> ItemField;
@@ -152,6 +161,20 @@ public:
 	{
 		ItemField (offset + index * sizeof (T)).write (it, value);
 	}
+
+	value_type read (std::vector<uint8_t>::const_iterator it) const
+	{
+		value_type values;
+		for (unsigned int i = 0; i < Count; ++i)
+			values[i] = read (it, i);
+		return values;
+	}
+
+	void write (std::vector<uint8_t>::iterator it, const value_type &values) const
+	{
+		for (unsigned int i = 0; i < Count; ++i)
+			write (it, i, values[i]);
+	}
 };
 
 template<std::size_t S>
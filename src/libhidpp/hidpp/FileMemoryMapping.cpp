@@ -0,0 +1,157 @@
+/*
+ * Copyright 2026 Clément Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "FileMemoryMapping.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <system_error>
+
+extern "C" {
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+}
+
+using namespace HIDPP;
+
+FileMemoryMapping::FileMemoryMapping (const std::string &path, std::size_t page_size,
+				      OffsetUnit unit, bool writable,
+				      bool write_crc, int mem_type):
+	AbstractMemoryMapping (write_crc),
+	_data (nullptr),
+	_size (0),
+	_page_size (page_size),
+	_unit (unit),
+	_writable (writable),
+	_mem_type (mem_type)
+{
+	if (page_size == 0)
+		throw std::invalid_argument ("page size is zero");
+	_fd = ::open (path.c_str (), writable ? O_RDWR : O_RDONLY);
+	if (_fd == -1)
+		throw std::system_error (errno, std::system_category (), "open");
+	struct stat st;
+	if (-1 == fstat (_fd, &st)) {
+		int err = errno;
+		::close (_fd);
+		throw std::system_error (err, std::system_category (), "fstat");
+	}
+	_size = st.st_size;
+	if (_size % page_size != 0) {
+		::close (_fd);
+		throw std::invalid_argument ("file size is not a multiple of the page size");
+	}
+	if (_size > 0) {
+		void *data = mmap (nullptr, _size, writable ? PROT_READ | PROT_WRITE : PROT_READ,
+				   MAP_SHARED, _fd, 0);
+		if (data == MAP_FAILED) {
+			int err = errno;
+			::close (_fd);
+			throw std::system_error (err, std::system_category (), "mmap");
+		}
+		_data = static_cast<uint8_t *> (data);
+	}
+	if (mem_type >= 0)
+		setPageLayout (mem_type + 1, pageCount (), page_size);
+}
+
+FileMemoryMapping::FileMemoryMapping (std::size_t page_count, std::size_t page_size,
+				      OffsetUnit unit, bool write_crc, int mem_type):
+	AbstractMemoryMapping (write_crc),
+	_fd (-1),
+	_data (nullptr),
+	_size (page_count * page_size),
+	_page_size (page_size),
+	_unit (unit),
+	_writable (true),
+	_mem_type (mem_type)
+{
+	if (page_size == 0)
+		throw std::invalid_argument ("page size is zero");
+	if (_size > 0) {
+		void *data = mmap (nullptr, _size, PROT_READ | PROT_WRITE,
+				   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (data == MAP_FAILED)
+			throw std::system_error (errno, std::system_category (), "mmap");
+		_data = static_cast<uint8_t *> (data);
+		std::fill_n (_data, _size, 0xff);
+	}
+	if (mem_type >= 0)
+		setPageLayout (mem_type + 1, pageCount (), page_size);
+}
+
+FileMemoryMapping::~FileMemoryMapping ()
+{
+	stopStreaming ();
+	if (_data)
+		munmap (_data, _size);
+	if (_fd != -1)
+		::close (_fd);
+}
+
+std::size_t FileMemoryMapping::pageCount () const
+{
+	return _size / _page_size;
+}
+
+std::vector<uint8_t>::const_iterator FileMemoryMapping::getReadOnlyIterator (const Address &address)
+{
+	auto &page = getReadOnlyPage (address);
+	return page.begin () + address.offset * static_cast<unsigned int> (_unit);
+}
+
+std::vector<uint8_t>::iterator FileMemoryMapping::getWritableIterator (const Address &address)
+{
+	auto &page = getWritablePage (address);
+	return page.begin () + address.offset * static_cast<unsigned int> (_unit);
+}
+
+bool FileMemoryMapping::computeOffset (std::vector<uint8_t>::const_iterator it, Address &address)
+{
+	auto &page = getReadOnlyPage (address);
+	int dist = distance (page.begin (), it);
+	int unit = static_cast<int> (_unit);
+	if (dist % unit != 0)
+		return false;
+	address.offset = dist / unit;
+	return true;
+}
+
+uint8_t *FileMemoryMapping::pageData (const Address &address) const
+{
+	if (address.mem_type != _mem_type || address.page >= pageCount ())
+		throw std::out_of_range ("Address is not in the memory image");
+	return _data + address.page * _page_size;
+}
+
+void FileMemoryMapping::readPage (const Address &address, std::vector<uint8_t> &data)
+{
+	auto page = pageData (address);
+	data.assign (page, page + _page_size);
+}
+
+void FileMemoryMapping::writePage (const Address &address, const std::vector<uint8_t> &data)
+{
+	if (!_writable)
+		throw std::logic_error ("Memory image is read-only");
+	auto page = pageData (address);
+	std::copy_n (data.begin (), std::min (data.size (), _page_size), page);
+}
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2026 Clément Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef LIBHIDPP_HIDPP_FILE_MEMORY_MAPPING_H
+#define LIBHIDPP_HIDPP_FILE_MEMORY_MAPPING_H
+
+#include <hidpp/AbstractMemoryMapping.h>
+#include <string>
+
+namespace HIDPP
+{
+
+/**
+ * Memory mapping backed by a memory image file (or RAM) instead of a device.
+ *
+ * The file is mapped with mmap and contains consecutive pages of
+ * \p page_size bytes (e.g. the output of hidpp10-dump-page or
+ * hidpp20-dump-page). Offsets are converted the same way as
+ * HIDPP10::MemoryMapping (16 bits words) or HIDPP20::MemoryMapping
+ * (bytes) depending on \p unit, so profile, macro and profile
+ * directory formats can be used offline.
+ *
+ * Only addresses with memory type \p mem_type are valid.
+ */
+class FileMemoryMapping: public AbstractMemoryMapping
+{
+public:
+	enum class OffsetUnit {
+		Byte = 1,	///< HID++ 2.0 addresses
+		Word = 2,	///< HID++ 1.0 addresses
+	};
+
+	/**
+	 * \param path		Image file.
+	 * \param page_size	Size of each page in the image.
+	 * \param unit		Unit used by address offsets.
+	 * \param writable	Open the file for writing, sync() writes
+	 *			modified pages back to the file.
+	 * \param write_crc	Write the page CRC on sync().
+	 * \param mem_type	Memory type of the pages in the file.
+	 *
+	 * \throws std::system_error if the file cannot be opened or mapped.
+	 * \throws std::invalid_argument if \p page_size is zero or the file
+	 * size is not a multiple of it.
+	 */
+	FileMemoryMapping (const std::string &path, std::size_t page_size,
+			   OffsetUnit unit, bool writable = false,
+			   bool write_crc = true, int mem_type = 0);
+	/**
+	 * Writable anonymous image of \p page_count pages in RAM, filled
+	 * with 0xff like erased flash memory.
+	 *
+	 * \throws std::system_error if the memory cannot be mapped.
+	 * \throws std::invalid_argument if \p page_size is zero.
+	 */
+	FileMemoryMapping (std::size_t page_count, std::size_t page_size,
+			   OffsetUnit unit, bool write_crc = true, int mem_type = 0);
+	~FileMemoryMapping ();
+
+	FileMemoryMapping (const FileMemoryMapping &) = delete;
+	FileMemoryMapping &operator= (const FileMemoryMapping &) = delete;
+
+	/**
+	 * Number of pages in the image.
+	 */
+	std::size_t pageCount () const;
+
+	virtual std::vector<uint8_t>::const_iterator getReadOnlyIterator (const Address &address);
+	virtual std::vector<uint8_t>::iterator getWritableIterator (const Address &address);
+	virtual bool computeOffset (std::vector<uint8_t>::const_iterator it, Address &address);
+
+protected:
+	virtual void readPage (const Address &address, std::vector<uint8_t> &data);
+	virtual void writePage (const Address &address, const std::vector<uint8_t> &data);
+
+private:
+	uint8_t *pageData (const Address &address) const;
+
+	int _fd;
+	uint8_t *_data;
+	std::size_t _size;
+	std::size_t _page_size;
+	OffsetUnit _unit;
+	bool _writable;
+	int _mem_type;
+};
+
+}
+
+#endif
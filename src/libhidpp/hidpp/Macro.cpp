@@ -24,9 +24,11 @@
 #include <misc/Log.h>
 
 #include <cassert>
+#include <algorithm>
 #include <map>
 #include <vector>
 #include <stack>
+#include <stdexcept>
 #include <iterator>
 
 using namespace HIDPP;
@@ -59,7 +61,9 @@ const std::map<Macro::Item::Instruction, std::string> Macro::Item::InstructionSt
 };
 
 Macro::Item::Item (Instruction instr):
-	_instr (instr)
+	_instr (instr),
+	_params (),
+	_dest (0)
 {
 }
 
@@ -139,17 +143,12 @@ bool Macro::Item::isJump () const
 	return _instr == Jump || _instr == JumpIfPressed || _instr == JumpIfReleased;
 }
 
-std::list<Macro::Item>::iterator Macro::Item::jumpDestination ()
+std::size_t Macro::Item::jumpDestination () const
 {
 	return _dest;
 }
 
-std::list<Macro::Item>::const_iterator Macro::Item::jumpDestination () const
-{
-	return _dest;
-}
-
-void Macro::Item::setJumpDestination (std::list<Item>::iterator dest)
+void Macro::Item::setJumpDestination (std::size_t dest)
 {
 	_dest = dest;
 }
@@ -219,8 +218,20 @@ Macro::Macro ()
 
 Macro::Macro (const AbstractMacroFormat &format, AbstractMemoryMapping &mem, Address address)
 {
-	std::map<Address, iterator> parsed_items;
-	std::vector<std::pair <Item *, Address>> incomplete_ref;
+	// Aligned items sorted by address, macros are mostly parsed in
+	// increasing address order so insertions are usually at the end.
+	typedef std::pair<Address, std::size_t> AddressIndex;
+	std::vector<AddressIndex> parsed_items;
+	auto find_item = [&parsed_items] (const Address &address) {
+		auto it = std::lower_bound (parsed_items.begin (), parsed_items.end (), address,
+					    [] (const AddressIndex &item, const Address &address) {
+			return item.first < address;
+		});
+		if (it != parsed_items.end () && address < it->first)
+			return parsed_items.end ();
+		return it;
+	};
+	std::vector<std::pair<std::size_t, Address>> incomplete_ref;
 
 	std::vector<uint8_t>::const_iterator current = mem.getReadOnlyIterator (address);
 
@@ -228,17 +239,23 @@ Macro::Macro (const AbstractMacroFormat &format, AbstractMemoryMapping &mem, Add
 	while (true) {
 		Address dest;
 		auto last = current;
+		std::size_t index = _items.size ();
 		_items.emplace_back (format.parseItem (current, dest));
-		Item &item = _items.back ();
+		const Item &item = _items.back ();
 
 		// Memorize aligned items by address
-		if (mem.computeOffset (last, address)) {
-			parsed_items.emplace (address, std::prev(_items.end ()));
+		if (mem.computeOffset (last, address) &&
+		    find_item (address) == parsed_items.end ()) {
+			auto pos = std::upper_bound (parsed_items.begin (), parsed_items.end (), address,
+						     [] (const Address &address, const AddressIndex &item) {
+				return address < item.first;
+			});
+			parsed_items.emplace (pos, address, index);
 		}
 
 		if (item.isJump ()) {
 			jump_dests.push (dest); // Keep destination for later parsing
-			incomplete_ref.emplace_back (&item, dest);
+			incomplete_ref.emplace_back (index, dest);
 		}
 
 		if (!item.hasSuccessor ()) {
@@ -248,60 +265,45 @@ Macro::Macro (const AbstractMacroFormat &format, AbstractMemoryMapping &mem, Add
 					goto parse_end;
 				address = jump_dests.top ();
 				jump_dests.pop ();
-			} while (parsed_items.find (address) != parsed_items.end ());
+			} while (find_item (address) != parsed_items.end ());
 
 			current = mem.getReadOnlyIterator (address);
 		}
 	}
 parse_end:
 
-	for (auto pair: incomplete_ref) {
-		// Find item iterator at referenced address
-		Item *item = pair.first;
-		const Address &address = pair.second;
-		item->setJumpDestination (parsed_items.at (address));
+	for (const auto &pair: incomplete_ref) {
+		// Find item index at referenced address
+		auto it = find_item (pair.second);
+		if (it == parsed_items.end ())
+			throw std::out_of_range ("Macro jump destination not found");
+		_items[pair.first].setJumpDestination (it->second);
 	}
 }
 
-Macro::Macro (const Macro &other):
-	_items (other._items)
+Address Macro::write (const AbstractMacroFormat &format, AbstractMemoryMapping &mem, Address &start) const
 {
-	auto debug = Log::debug ("macro");
-	debug << "Copying macro" << std::endl;
-	// The destination of every jump needs to be corrected in the copied list
-	std::map<const Item *, iterator> translation;
-
-	const_iterator other_it = other._items.begin ();
-	for (iterator it = _items.begin ();
-	     it != _items.end ();
-	     ++it, ++other_it) {
-		debug.printf ("Add translation %p to %p\n", &(*other_it), &(*it));
-		translation.insert ({ &(*other_it), it });
-	}
-
-	for (Item &item: _items) {
-		if (item.isJump ()) {
-			Item *old_item = &(*item.jumpDestination ());
-			iterator new_item = translation[old_item];
-			debug.printf ("Replace %p with %p\n", old_item, &(*new_item));
-
-			item.setJumpDestination (new_item);
-		}
-	}
+	std::vector<Address> entry_addresses;
+	return write (format, mem, start, {}, entry_addresses);
 }
 
-Address Macro::write (const AbstractMacroFormat &format, AbstractMemoryMapping &mem, Address &start) const
+Address Macro::write (const AbstractMacroFormat &format, AbstractMemoryMapping &mem, Address &start,
+		      const std::vector<std::size_t> &entries,
+		      std::vector<Address> &entry_addresses) const
 {
 	auto debug = Log::debug ("macro");
 	typedef std::vector<uint8_t>::iterator iterator;
-	std::map<const Item *, Address> jump_dests; // Associate address with jump destination items
-	std::vector<std::pair<const Item *, iterator>> jump_addrs; // Jumps and their address positions
+	std::vector<bool> is_jump_dest_item (_items.size (), false);
+	std::vector<Address> item_addrs (_items.size ()); // Addresses of jump destination and entry items
+	std::vector<std::pair<std::size_t, iterator>> jump_addrs; // Jumps and their address positions
 
-	for (auto item: _items) {
+	for (const Item &item: _items) {
 		if (item.isJump ()) {
-			jump_dests.emplace(&*item.jumpDestination (), Address ());
+			is_jump_dest_item[item.jumpDestination ()] = true;
 		}
 	}
+	for (std::size_t entry: entries)
+		is_jump_dest_item.at (entry) = true;
 
 	Address current_page = start;
 	current_page.offset = 0;
@@ -313,10 +315,9 @@ Address Macro::write (const AbstractMacroFormat &format, AbstractMemoryMapping &
 	bool check_end_of_page_jump = true;
 	bool first_instruction = true;
 
-	for (auto it = _items.begin (); it != _items.end (); ++it) {
-		const Item &item = *it;
-		auto jump_dest = jump_dests.find (&item);
-		bool is_jump_dest = jump_dest != jump_dests.end ();
+	for (std::size_t index = 0; index < _items.size (); ++index) {
+		const Item &item = _items[index];
+		bool is_jump_dest = is_jump_dest_item[index];
 
 		std::size_t item_len = format.getLength (item);
 
@@ -336,12 +337,12 @@ Address Macro::write (const AbstractMacroFormat &format, AbstractMemoryMapping &
 				debug << "Check end of page jump at " << std::distance (instr_location, page_end) << " bytes from the end" << std::endl;
 				bool need_jump = false;
 				instr_location += item_len;
-				for (auto it2 = std::next(it); it2 != _items.end (); ++it2) {
-					while (!mem.computeOffset (instr_location, item_addr) && jump_dests.count (&*it2) > 0) {
+				for (std::size_t index2 = index+1; index2 < _items.size (); ++index2) {
+					while (!mem.computeOffset (instr_location, item_addr) && is_jump_dest_item[index2]) {
 						// Padding will be needed
 						++instr_location;
 					}
-					instr_location += format.getLength (*it2);
+					instr_location += format.getLength (_items[index2]);
 					if ((int) CRCLength > std::distance (instr_location, page_end)) {
 						// index reached end of page
 						need_jump = true;
@@ -352,7 +353,7 @@ Address Macro::write (const AbstractMacroFormat &format, AbstractMemoryMapping &
 					// Jump to the beginning of the next page
 					++current_page.page;
 					if (!first_instruction) {
-						assert (std::distance (current, page_end) > (int) (jump_len + CRCLength));
+						assert (std::distance (current, page_end) >= (int) (jump_len + CRCLength));
 						debug << "Adding jump to page " << current_page.page << std::endl;
 						format.writeJump (current, current_page);
 					}
@@ -385,12 +386,12 @@ Address Macro::write (const AbstractMacroFormat &format, AbstractMemoryMapping &
 
 		// Remember jump address position for later resolution
 		if (item.isJump ()) {
-			jump_addrs.emplace_back (&item, jump_addr_it);
+			jump_addrs.emplace_back (index, jump_addr_it);
 		}
 
 		// Remember item address for later jump resolution
 		if (is_jump_dest) {
-			jump_dest->second = item_addr;
+			item_addrs[index] = item_addr;
 		}
 
 		if (first_instruction)
@@ -399,12 +400,15 @@ Address Macro::write (const AbstractMacroFormat &format, AbstractMemoryMapping &
 
 	// Write jump addresses
 	for (auto jump_addr: jump_addrs) {
-		const Item &dest = *jump_addr.first->jumpDestination ();
-		const Address &addr = jump_dests.at (&dest);
+		const Address &addr = item_addrs[_items[jump_addr.first].jumpDestination ()];
 		auto jump_addr_it = jump_addr.second;
 		format.writeAddress (jump_addr_it, addr);
 	}
 
+	entry_addresses.clear ();
+	for (std::size_t entry: entries)
+		entry_addresses.push_back (item_addrs[entry]);
+
 	// Return the next valid address
 	Address next_addr = current_page;
 	while (!mem.computeOffset (current, next_addr))
@@ -415,50 +419,322 @@ Address Macro::write (const AbstractMacroFormat &format, AbstractMemoryMapping &
 void Macro::simplify ()
 {
 	auto debug = Log::debug ("macro");
-	std::map<Item *, std::vector<Item *>> back_refs;
+	// next_kept[i] is the index of the first item kept at or after i
+	std::vector<std::size_t> next_kept (_items.size () + 1);
+	std::vector<bool> removed (_items.size (), false);
+	next_kept[_items.size ()] = _items.size ();
+	for (std::size_t i = _items.size (); i-- > 0;) {
+		const Item &item = _items[i];
+		bool useless = item.instruction () == Item::NoOp ||
+			(item.instruction () == Item::Jump &&
+			 item.jumpDestination () > i &&
+			 next_kept[item.jumpDestination ()] == next_kept[i+1]);
+		if (useless) {
+			debug.printf ("Remove useless macro item %zu: instruction = %d\n", i, item.instruction ());
+			next_kept[i] = next_kept[i+1];
+			removed[i] = true;
+		}
+		else
+			next_kept[i] = i;
+	}
+	removeItems (removed);
+}
 
-	for (auto item: _items) {
-		if (item.isJump ()) {
-			back_refs[&*item.jumpDestination ()].push_back (&item);
+namespace
+{
+
+/**
+ * \returns the length of \p item encoded with \p format, or 0 if it is
+ * not supported. Delays must be encoded exactly.
+ */
+std::size_t encodedLength (const AbstractMacroFormat &format, const Macro::Item &item)
+{
+	try {
+		std::size_t length = format.getLength (item);
+		if (item.instruction () == Macro::Item::Delay ||
+		    item.instruction () == Macro::Item::ShortDelay) {
+			std::vector<uint8_t> buffer (length);
+			std::vector<uint8_t>::iterator jump_addr_it;
+			format.writeItem (buffer.begin (), item, jump_addr_it);
+			std::vector<uint8_t>::const_iterator it = buffer.begin ();
+			Address jump_addr;
+			if (format.parseItem (it, jump_addr).delay () != item.delay ())
+				return 0;
 		}
+		return length;
+	}
+	catch (AbstractMacroFormat::UnsupportedInstruction &e) {
+		return 0;
+	}
+}
+
+bool isDelay (const Macro::Item &item)
+{
+	return item.instruction () == Macro::Item::Delay ||
+		item.instruction () == Macro::Item::ShortDelay;
+}
+
+bool isConsumerControl (const Macro::Item &item)
+{
+	return item.instruction () == Macro::Item::ConsumerControl ||
+		item.instruction () == Macro::Item::ConsumerControlPress ||
+		item.instruction () == Macro::Item::ConsumerControlRelease;
+}
+
+}
+
+void Macro::optimize (const AbstractMacroFormat &format)
+{
+	auto debug = Log::debug ("macro");
+
+	// Remove unreachable items
+	{
+		std::vector<bool> reachable (_items.size (), false);
+		std::stack<std::size_t> pending;
+		pending.push (0);
+		while (!pending.empty ()) {
+			std::size_t i = pending.top ();
+			pending.pop ();
+			if (i >= _items.size () || reachable[i])
+				continue;
+			reachable[i] = true;
+			if (_items[i].isJump ())
+				pending.push (_items[i].jumpDestination ());
+			if (_items[i].hasSuccessor ())
+				pending.push (i+1);
+		}
+		std::vector<bool> removed (_items.size ());
+		for (std::size_t i = 0; i < _items.size (); ++i) {
+			removed[i] = !reachable[i];
+			if (removed[i])
+				debug.printf ("Remove unreachable macro item %zu\n", i);
+		}
+		removeItems (removed);
 	}
 
+	std::vector<bool> targets = jumpTargets ();
+	// Find the consumer control item following i in the same straight
+	// sequence of simple items.
+	auto next_cc = [this, &targets] (std::size_t i) {
+		for (std::size_t j = i+1; j < _items.size (); ++j) {
+			if (targets[j] || !_items[j].isSimple ())
+				break;
+			if (isConsumerControl (_items[j]))
+				return j;
+		}
+		return _items.size ();
+	};
+
+	// Convert consumer control items to the kind supported by the
+	// format. Every press must be followed by its release in the same
+	// sequence, so no control is pressed between the pairs.
+	Item cc (Item::ConsumerControl), cc_press (Item::ConsumerControlPress), cc_release (Item::ConsumerControlRelease);
+	cc.setConsumerControl (0);
+	cc_press.setConsumerControl (0);
+	cc_release.setConsumerControl (0);
+	bool has_cc = encodedLength (format, cc) > 0;
+	bool has_cc_press = encodedLength (format, cc_press) > 0 && encodedLength (format, cc_release) > 0;
+	if (has_cc != has_cc_press) {
+		Item::Instruction press = has_cc ? Item::ConsumerControlPress : Item::ConsumerControl;
+		std::vector<std::pair<std::size_t, std::size_t>> pairs;
+		bool convertible = true;
+		for (std::size_t i = 0; convertible && i < _items.size (); ++i) {
+			if (!isConsumerControl (_items[i]))
+				continue;
+			std::size_t j;
+			if (_items[i].instruction () != press ||
+			    _items[i].consumerControl () == 0 ||
+			    (j = next_cc (i)) == _items.size ())
+				convertible = false;
+			else if (has_cc)
+				convertible = _items[j].instruction () == Item::ConsumerControlRelease &&
+					_items[j].consumerControl () == _items[i].consumerControl ();
+			else
+				convertible = _items[j].instruction () == Item::ConsumerControl &&
+					_items[j].consumerControl () == 0;
+			if (convertible) {
+				pairs.emplace_back (i, j);
+				i = j;
+			}
+		}
+		if (convertible) {
+			for (const auto &pair: pairs) {
+				uint16_t usage = _items[pair.first].consumerControl ();
+				Item &p = _items[pair.first] = has_cc ? Item::ConsumerControl : Item::ConsumerControlPress;
+				Item &r = _items[pair.second] = has_cc ? Item::ConsumerControl : Item::ConsumerControlRelease;
+				p.setConsumerControl (usage);
+				r.setConsumerControl (has_cc ? 0 : usage);
+			}
+		}
+	}
 
-	auto it = _items.begin ();
-	while (it != _items.end ()) {
-		if (it->instruction () == Item::NoOp ||
-		    (it->instruction () == Item::Jump && it->jumpDestination () == std::next(it))) {
-			for (Item *jump: back_refs[&*it]) {
-				jump->setJumpDestination (std::next(it));
+	// Combine modifiers and key items, and merge delays
+	std::vector<bool> removed (_items.size (), false);
+	for (std::size_t i = 0; i+1 < _items.size (); ++i) {
+		std::size_t j = i+1;
+		if (targets[j])
+			continue;
+		Item &a = _items[i], &b = _items[j];
+		if (isDelay (a) && isDelay (b)) {
+			Item merged (Item::Delay);
+			merged.setDelay (a.delay () + b.delay ());
+			if (encodedLength (format, merged) > 0) {
+				b = merged;
+				removed[i] = true;
 			}
-			debug.printf ("Remove useless macro item %p: instruction = %d\n", &*it, it->instruction ());
-			it = _items.erase (it);
+			continue;
 		}
+		Item::Instruction combined;
+		if (a.instruction () == Item::ModifiersPress && b.instruction () == Item::KeyPress)
+			combined = Item::ModifiersKeyPress;
+		else if (a.instruction () == Item::ModifiersRelease && b.instruction () == Item::KeyRelease)
+			combined = Item::ModifiersKeyRelease;
 		else
-			++it;
+			continue;
+		Item item (combined);
+		item.setModifiers (a.modifiers ());
+		item.setKeyCode (b.keyCode ());
+		std::size_t length = encodedLength (format, item);
+		if (length > 0 && length < encodedLength (format, a) + encodedLength (format, b)) {
+			b = item;
+			removed[i] = true;
+		}
+	}
+	for (std::size_t i = 0; i < _items.size (); ++i) {
+		if (!removed[i] && isDelay (_items[i]) && _items[i].delay () == 0)
+			removed[i] = true;
+	}
+	removeItems (removed);
+
+	// Use the shortest equivalent instruction
+	for (Item &item: _items) {
+		std::vector<Item> candidates;
+		switch (item.instruction ()) {
+		case Item::Delay:
+		case Item::ShortDelay:
+			candidates = { Item::Delay, Item::ShortDelay };
+			for (Item &c: candidates)
+				c.setDelay (item.delay ());
+			break;
+		case Item::KeyPress:
+		case Item::KeyRelease:
+		case Item::ModifiersPress:
+		case Item::ModifiersRelease:
+		case Item::ModifiersKeyPress:
+		case Item::ModifiersKeyRelease: {
+			bool press = item.instruction () == Item::KeyPress ||
+				item.instruction () == Item::ModifiersPress ||
+				item.instruction () == Item::ModifiersKeyPress;
+			bool has_key = item.instruction () != Item::ModifiersPress &&
+				item.instruction () != Item::ModifiersRelease;
+			bool has_modifiers = item.instruction () != Item::KeyPress &&
+				item.instruction () != Item::KeyRelease;
+			uint8_t key = has_key ? item.keyCode () : 0;
+			uint8_t modifiers = has_modifiers ? item.modifiers () : 0;
+			Item combined (press ? Item::ModifiersKeyPress : Item::ModifiersKeyRelease);
+			combined.setModifiers (modifiers);
+			combined.setKeyCode (key);
+			candidates.push_back (combined);
+			if (modifiers == 0) {
+				candidates.emplace_back (press ? Item::KeyPress : Item::KeyRelease);
+				candidates.back ().setKeyCode (key);
+			}
+			if (key == 0) {
+				candidates.emplace_back (press ? Item::ModifiersPress : Item::ModifiersRelease);
+				candidates.back ().setModifiers (modifiers);
+			}
+			break;
+		}
+		default:
+			continue;
+		}
+		std::size_t best = encodedLength (format, item);
+		for (const Item &c: candidates) {
+			std::size_t length = encodedLength (format, c);
+			if (length > 0 && (best == 0 || length < best)) {
+				item = c;
+				best = length;
+			}
+		}
+	}
+
+	simplify ();
+}
+
+void Macro::removeItems (const std::vector<bool> &removed)
+{
+	// next_kept[i] is the index of the first item kept at or after i,
+	// jumps to removed items are moved to it.
+	std::vector<std::size_t> next_kept (_items.size () + 1);
+	next_kept[_items.size ()] = _items.size ();
+	for (std::size_t i = _items.size (); i-- > 0;)
+		next_kept[i] = removed[i] ? next_kept[i+1] : i;
+
+	// Compact kept items and compute their new indexes
+	std::vector<std::size_t> new_index (_items.size () + 1);
+	std::size_t count = 0;
+	for (std::size_t i = 0; i < _items.size (); ++i) {
+		if (!removed[i]) {
+			new_index[i] = count;
+			if (count != i)
+				_items[count] = _items[i];
+			++count;
+		}
+	}
+	new_index[_items.size ()] = count;
+	_items.erase (_items.begin () + count, _items.end ());
+
+	for (Item &item: _items) {
+		if (item.isJump ())
+			item.setJumpDestination (new_index[next_kept[item.jumpDestination ()]]);
+	}
+}
+
+std::vector<bool> Macro::jumpTargets () const
+{
+	std::vector<bool> targets (_items.size (), false);
+	for (const Item &item: _items) {
+		if (item.isJump () && item.jumpDestination () < _items.size ())
+			targets[item.jumpDestination ()] = true;
 	}
+	return targets;
 }
 
-std::list<Macro::Item>::iterator Macro::begin ()
+Macro::iterator Macro::begin ()
 {
 	return _items.begin ();
 }
 
-std::list<Macro::Item>::const_iterator Macro::begin () const
+Macro::const_iterator Macro::begin () const
 {
 	return _items.begin ();
 }
 
-std::list<Macro::Item>::iterator Macro::end ()
+Macro::iterator Macro::end ()
 {
 	return _items.end ();
 }
 
-std::list<Macro::Item>::const_iterator Macro::end () const
+Macro::const_iterator Macro::end () const
 {
 	return _items.end ();
 }
 
+std::size_t Macro::size () const
+{
+	return _items.size ();
+}
+
+const Macro::Item &Macro::operator[] (std::size_t index) const
+{
+	return _items[index];
+}
+
+Macro::Item &Macro::operator[] (std::size_t index)
+{
+	return _items[index];
+}
+
 const Macro::Item &Macro::back () const
 {
 	return _items.back ();
@@ -469,6 +745,11 @@ Macro::Item &Macro::back ()
 	return _items.back ();
 }
 
+Macro::const_iterator Macro::jumpDestination (const_iterator jump) const
+{
+	return _items.begin () + jump->jumpDestination ();
+}
+
 void Macro::emplace_back (Item::Instruction instr)
 {
 	_items.emplace_back (instr);
@@ -516,15 +797,11 @@ bool Macro::isLoop (const_iterator &pre_begin, const_iterator &pre_end,
 			break;
 
 		case Item::JumpIfPressed: {
-			const_iterator dest = it->jumpDestination ();
+			const_iterator dest = jumpDestination (it);
 			if (state == Init) {
 				// Check that the destination is before
 				// the current instruction.
-				const_iterator it2;
-				for (it2 = _items.begin (); it2 != it; ++it2)
-					if (it2 == dest)
-						break;
-				if (it2 == it) // dest not found
+				if (dest >= it)
 					return false;
 
 				pre_end = dest;
@@ -538,7 +815,7 @@ bool Macro::isLoop (const_iterator &pre_begin, const_iterator &pre_end,
 				loop_end = it;
 				post_begin = std::next (it);
 				// Check jump destinations (pre_end is JumpIfReleased)
-				if (pre_end->jumpDestination () != post_begin ||
+				if (jumpDestination (pre_end) != post_begin ||
 				    dest != loop_begin)
 					return false;
 				state = AfterLoop;
@@ -621,15 +898,19 @@ Macro Macro::buildLoop (const_iterator pre_begin, const_iterator pre_end,
 	else if (loop_delay > 0) {
 		// Use JumpIfReleased to delay the loop
 		macro._items.insert (macro._items.end (), pre_begin, pre_end);
-		iterator released_jump = macro._items.emplace (macro._items.end (), Item::JumpIfReleased);
-		iterator loop = macro._items.insert (macro._items.end (), loop_begin, loop_end);
-		iterator pressed_jump = macro._items.emplace (macro._items.end (), Item::JumpIfPressed);
-		iterator post = macro._items.insert (macro._items.end (), post_begin, post_end);
+		std::size_t released_jump = macro._items.size ();
+		macro._items.emplace_back (Item::JumpIfReleased);
+		std::size_t loop = macro._items.size ();
+		macro._items.insert (macro._items.end (), loop_begin, loop_end);
+		std::size_t pressed_jump = macro._items.size ();
+		macro._items.emplace_back (Item::JumpIfPressed);
+		std::size_t post = macro._items.size ();
+		macro._items.insert (macro._items.end (), post_begin, post_end);
 		macro._items.emplace_back (Item::End);
 
-		released_jump->setDelay (loop_delay);
-		released_jump->setJumpDestination (post);
-		pressed_jump->setJumpDestination (loop);
+		macro._items[released_jump].setDelay (loop_delay);
+		macro._items[released_jump].setJumpDestination (post);
+		macro._items[pressed_jump].setJumpDestination (loop);
 	}
 	else if (pre_begin == pre_end) {
 		// No pre-loop instruction, use repeat instruction
@@ -642,8 +923,10 @@ Macro Macro::buildLoop (const_iterator pre_begin, const_iterator pre_end,
 		// Pre-loop is non-empty, and loop is played at least once
 		// Use a single JumpIfpressed at the end of loop
 		macro._items.insert (macro._items.end (), pre_begin, pre_end);
-		iterator loop = macro._items.insert (macro._items.end (), loop_begin, loop_end);
-		macro._items.emplace (macro._items.end (), Item::JumpIfPressed)->setJumpDestination (loop);
+		std::size_t loop = macro._items.size ();
+		macro._items.insert (macro._items.end (), loop_begin, loop_end);
+		macro._items.emplace_back (Item::JumpIfPressed);
+		macro._items.back ().setJumpDestination (loop);
 		macro._items.insert (macro._items.end (), post_begin, post_end);
 		macro._items.emplace_back (Item::End);
 	}
@@ -22,7 +22,7 @@
 #include <string>
 #include <map>
 #include <cstdint>
-#include <list>
+#include <vector>
 #include <hidpp/Address.h>
 
 namespace HIDPP
@@ -32,7 +32,10 @@ class AbstractMacroFormat;
 class AbstractMemoryMapping;
 
 /**
- * Store a macro as a list of macro items.
+ * Store a macro as a contiguous array of macro items.
+ *
+ * Jump destinations are stored as item indexes in the macro, so
+ * copying a macro does not require fixing its jumps.
  *
  * ### Loop macro
  *
@@ -248,20 +251,15 @@ public:
 		 */
 		bool isJump () const;
 		/**
-		 * \returns the destination of the jump.
-		 * \see setJumpDestination()
-		 */
-		std::list<Item>::iterator jumpDestination ();
-		/**
-		 * \returns the destination of the jump.
+		 * \returns the index of the jump destination in the macro.
 		 * \see setJumpDestination()
 		 */
-		std::list<Item>::const_iterator jumpDestination () const;
+		std::size_t jumpDestination () const;
 		/**
-		 * \param dest destination of the jump.
+		 * \param dest index of the jump destination in the macro.
 		 * \see jumpDestination()
 		 */
-		void setJumpDestination (std::list<Item>::iterator dest);
+		void setJumpDestination (std::size_t dest);
 
 		/**
 		 * \returns horizontal mouse pointer delta.
@@ -315,7 +313,7 @@ public:
 				int x, y;
 			} mouse;
 		} _params;
-		std::list<Item>::iterator _dest;
+		std::size_t _dest;
 	};
 
 	/**
@@ -332,10 +330,10 @@ public:
 	 */
 	Macro (const AbstractMacroFormat &format, AbstractMemoryMapping &mem, Address address);
 
-	explicit Macro (const Macro &);
+	Macro (const Macro &) = default;
 	Macro (Macro &&) = default;
 
-	Macro &operator= (const Macro &) = delete;
+	Macro &operator= (const Macro &) = default;
 	Macro &operator= (Macro &&) = default;
 
 	/**
@@ -351,23 +349,57 @@ public:
 	 * \returns the first address after the macro.
 	 */
 	Address write (const AbstractMacroFormat &format, AbstractMemoryMapping &mem, Address &start) const;
+	/**
+	 * Same as write() but the items at indexes \p entries are aligned
+	 * like jump destinations so that they can be used as the start of
+	 * other macros (e.g. for sharing a common tail).
+	 *
+	 * \param [in] entries		Indexes of the entry items.
+	 * \param [out] entry_addresses	Addresses of the entry items.
+	 */
+	Address write (const AbstractMacroFormat &format, AbstractMemoryMapping &mem, Address &start,
+		       const std::vector<std::size_t> &entries,
+		       std::vector<Address> &entry_addresses) const;
 
 	/**
 	 * Remove no-op and useless unconditional jumps.
 	 */
 	void simplify ();
 
-	typedef std::list<Item>::iterator iterator;
-	typedef std::list<Item>::const_iterator const_iterator;
+	/**
+	 * Make the macro shorter when encoded with \p format.
+	 *
+	 * Besides simplify(), unreachable items are removed, adjacent
+	 * delays are merged, modifier and key items are combined and
+	 * consumer control items are converted when the format supports
+	 * them, and every item uses its shortest encoding in \p format.
+	 *
+	 * The executed actions and their timing are not changed. Delays
+	 * are only changed when \p format encodes the resulting delay
+	 * exactly.
+	 */
+	void optimize (const AbstractMacroFormat &format);
+
+	typedef std::vector<Item>::iterator iterator;
+	typedef std::vector<Item>::const_iterator const_iterator;
 
 	iterator begin ();
 	const_iterator begin () const;
 	iterator end ();
 	const_iterator end () const;
 
+	std::size_t size () const;
+	const Item &operator[] (std::size_t index) const;
+	Item &operator[] (std::size_t index);
+
 	const Item &back () const;
 	Item &back ();
 
+	/**
+	 * \returns the destination of the jump item at \p jump.
+	 */
+	const_iterator jumpDestination (const_iterator jump) const;
+
 	void emplace_back (Item::Instruction instr);
 
 	/**
@@ -414,7 +446,17 @@ public:
 				unsigned int loop_delay);
 
 private:
-	std::list<Item> _items;
+	std::vector<Item> _items;
+
+	/**
+	 * Remove the items marked in \p removed. Jumps to removed items
+	 * are moved to the next kept item.
+	 */
+	void removeItems (const std::vector<bool> &removed);
+	/**
+	 * \returns items that are the destination of a jump.
+	 */
+	std::vector<bool> jumpTargets () const;
 };
 
 }
@@ -0,0 +1,212 @@
+/*
+ * Copyright 2026 Clément Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "MacroInterpreter.h"
+
+using namespace HIDPP;
+
+namespace
+{
+enum UsagePage: uint16_t {
+	GenericDesktop = 0x01,
+	Keyboard = 0x07,
+	Button = 0x09,
+	Consumer = 0x0c,
+};
+enum Usage: uint16_t {
+	X = 0x30,
+	Y = 0x31,
+	Wheel = 0x38,
+	ACPan = 0x0238,
+	LeftControl = 0xe0, // First modifier key
+};
+}
+
+bool MacroInterpreter::Event::operator== (const Event &other) const
+{
+	return time == other.time && usage_page == other.usage_page &&
+		usage == other.usage && value == other.value;
+}
+
+bool MacroInterpreter::Event::operator!= (const Event &other) const
+{
+	return !(*this == other);
+}
+
+MacroInterpreter::MacroInterpreter ():
+	_release_time (0),
+	_item_time (0),
+	_max_items (DefaultMaxItems),
+	_max_time (DefaultMaxTime)
+{
+}
+
+void MacroInterpreter::setReleaseTime (unsigned int release_time)
+{
+	_release_time = release_time;
+}
+
+unsigned int MacroInterpreter::releaseTime () const
+{
+	return _release_time;
+}
+
+void MacroInterpreter::setItemTime (unsigned int item_time)
+{
+	_item_time = item_time;
+}
+
+unsigned int MacroInterpreter::itemTime () const
+{
+	return _item_time;
+}
+
+void MacroInterpreter::setLimits (unsigned int max_items, unsigned int max_time)
+{
+	_max_items = max_items;
+	_max_time = max_time;
+}
+
+MacroInterpreter::Result MacroInterpreter::run (const Macro &macro) const
+{
+	Result result;
+	result.item_count = 0;
+	result.complete = false;
+
+	unsigned int now = 0;
+	uint16_t current_cc = 0;
+	auto event = [&result, &now] (uint16_t usage_page, uint16_t usage, int value) {
+		result.events.push_back ({ now, usage_page, usage, value });
+	};
+	auto key = [&event] (uint8_t key_code, int value) {
+		if (key_code != 0)
+			event (Keyboard, key_code, value);
+	};
+	auto modifiers = [&event] (uint8_t mask, int value) {
+		for (unsigned int i = 0; i < 8; ++i)
+			if (mask & (1<<i))
+				event (Keyboard, LeftControl+i, value);
+	};
+	auto buttons = [&event] (uint16_t mask, int value) {
+		for (unsigned int i = 0; i < 16; ++i)
+			if (mask & (1<<i))
+				event (Button, i+1, value);
+	};
+
+	std::size_t pc = 0;
+	while (pc < macro.size () && result.item_count < _max_items && now < _max_time) {
+		const Macro::Item &item = macro[pc];
+		++result.item_count;
+		now += _item_time;
+		bool pressed = now < _release_time;
+		++pc;
+		switch (item.instruction ()) {
+		case Macro::Item::NoOp:
+			break;
+		case Macro::Item::WaitRelease:
+			if (pressed)
+				now = _release_time;
+			break;
+		case Macro::Item::RepeatUntilRelease:
+			if (pressed)
+				pc = 0;
+			break;
+		case Macro::Item::RepeatForever:
+			pc = 0;
+			break;
+		case Macro::Item::KeyPress:
+			key (item.keyCode (), 1);
+			break;
+		case Macro::Item::KeyRelease:
+			key (item.keyCode (), 0);
+			break;
+		case Macro::Item::ModifiersPress:
+			modifiers (item.modifiers (), 1);
+			break;
+		case Macro::Item::ModifiersRelease:
+			modifiers (item.modifiers (), 0);
+			break;
+		case Macro::Item::ModifiersKeyPress:
+			modifiers (item.modifiers (), 1);
+			key (item.keyCode (), 1);
+			break;
+		case Macro::Item::ModifiersKeyRelease:
+			modifiers (item.modifiers (), 0);
+			key (item.keyCode (), 0);
+			break;
+		case Macro::Item::MouseWheel:
+			event (GenericDesktop, Wheel, item.wheel ());
+			break;
+		case Macro::Item::MouseHWheel:
+			event (Consumer, ACPan, item.wheel ());
+			break;
+		case Macro::Item::MouseButtonPress:
+			buttons (item.buttons (), 1);
+			break;
+		case Macro::Item::MouseButtonRelease:
+			buttons (item.buttons (), 0);
+			break;
+		case Macro::Item::ConsumerControl:
+			if (current_cc != 0)
+				event (Consumer, current_cc, 0);
+			current_cc = item.consumerControl ();
+			if (current_cc != 0)
+				event (Consumer, current_cc, 1);
+			break;
+		case Macro::Item::ConsumerControlPress:
+			event (Consumer, item.consumerControl (), 1);
+			break;
+		case Macro::Item::ConsumerControlRelease:
+			event (Consumer, item.consumerControl (), 0);
+			break;
+		case Macro::Item::Delay:
+		case Macro::Item::ShortDelay:
+			now += item.delay ();
+			break;
+		case Macro::Item::Jump:
+			pc = item.jumpDestination ();
+			break;
+		case Macro::Item::JumpIfPressed:
+			if (pressed)
+				pc = item.jumpDestination ();
+			break;
+		case Macro::Item::MousePointer:
+			if (item.mouseX () != 0)
+				event (GenericDesktop, X, item.mouseX ());
+			if (item.mouseY () != 0)
+				event (GenericDesktop, Y, item.mouseY ());
+			break;
+		case Macro::Item::JumpIfReleased:
+			// Wait for the release during the time-out
+			if (!pressed || _release_time <= now + item.delay ()) {
+				if (pressed)
+					now = _release_time;
+				pc = item.jumpDestination ();
+			}
+			else
+				now += item.delay ();
+			break;
+		case Macro::Item::End:
+			result.complete = true;
+			result.duration = now;
+			return result;
+		}
+	}
+	result.duration = now;
+	return result;
+}
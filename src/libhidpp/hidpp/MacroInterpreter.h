@@ -0,0 +1,112 @@
+/*
+ * Copyright 2026 Clément Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef LIBHIDPP_HIDPP_MACRO_INTERPRETER_H
+#define LIBHIDPP_HIDPP_MACRO_INTERPRETER_H
+
+#include <hidpp/Macro.h>
+
+#include <vector>
+#include <cstdint>
+
+namespace HIDPP
+{
+
+/**
+ * Execute a macro without a device.
+ *
+ * The macro button is pressed at time 0 and released at the time
+ * given by setReleaseTime(). Items are executed instantly unless
+ * setItemTime() is used, only delays and instructions waiting for the
+ * button make time pass.
+ *
+ * Actions are output as HID events so that equivalent macros give the
+ * same events whatever instructions they use (e.g. ModifiersKeyPress
+ * or ModifiersPress followed by KeyPress).
+ *
+ * \ingroup hidpp
+ */
+class MacroInterpreter
+{
+public:
+	struct Event
+	{
+		unsigned int time;	///< Time in milliseconds since the button press.
+		uint16_t usage_page;
+		uint16_t usage;
+		/**
+		 * 1 or 0 for pressing or releasing keys and buttons,
+		 * relative value for axes (pointer and wheels).
+		 */
+		int value;
+
+		bool operator== (const Event &other) const;
+		bool operator!= (const Event &other) const;
+	};
+
+	struct Result
+	{
+		std::vector<Event> events;
+		unsigned int duration;		///< Time when the macro ended or was stopped.
+		unsigned int item_count;	///< Number of executed items.
+		/**
+		 * False if the execution was stopped before the end of the macro
+		 * because the limits were reached (e.g. infinite loops).
+		 */
+		bool complete;
+	};
+
+	static constexpr unsigned int DefaultMaxItems = 100000;
+	static constexpr unsigned int DefaultMaxTime = 60000;
+
+	MacroInterpreter ();
+
+	/**
+	 * Time when the button is released (default is 0: immediately
+	 * after being pressed).
+	 */
+	void setReleaseTime (unsigned int release_time);
+	unsigned int releaseTime () const;
+
+	/**
+	 * Time needed for executing any item (default is 0).
+	 */
+	void setItemTime (unsigned int item_time);
+	unsigned int itemTime () const;
+
+	/**
+	 * Stop the execution after \p max_items items or when the time
+	 * reaches \p max_time.
+	 */
+	void setLimits (unsigned int max_items, unsigned int max_time);
+
+	/**
+	 * Execute \p macro from its first item.
+	 */
+	Result run (const Macro &macro) const;
+
+private:
+	unsigned int _release_time;
+	unsigned int _item_time;
+	unsigned int _max_items;
+	unsigned int _max_time;
+};
+
+}
+
+#endif
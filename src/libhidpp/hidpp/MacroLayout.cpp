@@ -0,0 +1,238 @@
+/*
+ * Copyright 2026 Clément Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "MacroLayout.h"
+
+#include <hidpp/AbstractMacroFormat.h>
+#include <hidpp/AbstractMemoryMapping.h>
+
+#include <misc/Log.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace HIDPP;
+
+MacroLayout::MacroLayout (const AbstractMacroFormat &format, AbstractMemoryMapping &mem):
+	_format (format),
+	_mem (mem),
+	_stored_count (0)
+{
+}
+
+std::size_t MacroLayout::add (const Macro &macro)
+{
+	Entry entry;
+	entry.macro = &macro;
+	for (std::size_t i = 0; i < macro.size (); ++i) {
+		const Macro::Item &item = macro[i];
+		std::vector<uint8_t> bytes (_format.getLength (item), 0);
+		std::vector<uint8_t>::iterator jump_addr_it;
+		_format.writeItem (bytes.begin (), item, jump_addr_it);
+		if (item.isJump ()) {
+			auto rel = static_cast<int32_t> (item.jumpDestination () - i);
+			for (unsigned int j = 0; j < sizeof (rel); ++j)
+				bytes.push_back (static_cast<uint32_t> (rel) >> (8*j));
+		}
+		entry.items.push_back (std::move (bytes));
+	}
+	entry.root = _entries.size ();
+	entry.offset = 0;
+	_entries.push_back (std::move (entry));
+	return _entries.size ()-1;
+}
+
+std::size_t MacroLayout::estimateLength (const Entry &root,
+					 const std::vector<std::size_t> &entry_points,
+					 std::size_t alignment) const
+{
+	std::size_t length = 0;
+	std::vector<bool> aligned (root.macro->size (), false);
+	for (std::size_t entry: entry_points)
+		aligned[entry] = true;
+	for (const auto &item: *root.macro) {
+		length += _format.getLength (item);
+		if (item.isJump ())
+			aligned[item.jumpDestination ()] = true;
+	}
+	// Every aligned item may need padding
+	length += std::count (aligned.begin (), aligned.end (), true) * (alignment-1);
+	return length;
+}
+
+void MacroLayout::write (const Address &first_page)
+{
+	auto debug = Log::debug ("macro");
+
+	// Find identical macros and tails, longest macros are processed
+	// first so that they become roots for the shorter ones.
+	std::vector<std::size_t> order (_entries.size ());
+	for (std::size_t i = 0; i < order.size (); ++i)
+		order[i] = i;
+	std::stable_sort (order.begin (), order.end (), [this] (std::size_t a, std::size_t b) {
+		return _entries[a].items.size () > _entries[b].items.size ();
+	});
+	std::vector<std::size_t> roots;
+	for (std::size_t i: order) {
+		Entry &entry = _entries[i];
+		const std::size_t n = entry.items.size ();
+		entry.root = i;
+		entry.offset = 0;
+		for (std::size_t r: roots) {
+			const Entry &root = _entries[r];
+			const std::size_t m = root.items.size ();
+			if (n == 0 ? m != 0 : !std::equal (entry.items.begin (), entry.items.end (),
+							  root.items.end () - n))
+				continue;
+			entry.root = r;
+			entry.offset = m - n;
+			break;
+		}
+		if (entry.root == i)
+			roots.push_back (i);
+		else
+			debug.printf ("Macro %zu is stored in macro %zu at item %zu\n",
+				      i, entry.root, entry.offset);
+	}
+	_stored_count = roots.size ();
+
+	// Entry points required in every root
+	std::vector<std::vector<std::size_t>> entry_points (_entries.size ());
+	for (const Entry &entry: _entries) {
+		auto &points = entry_points[entry.root];
+		if (entry.macro->size () > 0 &&
+		    std::find (points.begin (), points.end (), entry.offset) == points.end ())
+			points.push_back (entry.offset);
+	}
+
+	_pages.clear ();
+	_addresses.assign (_entries.size (), Address ());
+	if (_entries.empty ())
+		return;
+
+	// Page geometry, Macro::write keeps room for the CRC at the end of pages
+	constexpr std::size_t CRCLength = 2;
+	Address page_addr = first_page;
+	page_addr.offset = 0;
+	const auto &first = _mem.getWritablePage (page_addr);
+	const std::size_t capacity = first.size () - CRCLength;
+	std::size_t alignment = 1;
+	{
+		Address addr = page_addr;
+		while (!_mem.computeOffset (first.begin () + alignment, addr))
+			++alignment;
+	}
+
+	std::vector<std::size_t> lengths (_entries.size ());
+	for (std::size_t r: roots)
+		lengths[r] = estimateLength (_entries[r], entry_points[r], alignment);
+	std::stable_sort (roots.begin (), roots.end (), [&lengths] (std::size_t a, std::size_t b) {
+		return lengths[a] > lengths[b];
+	});
+
+	struct Bin {
+		Address page;
+		std::size_t used;
+	};
+	std::vector<Bin> bins;
+	auto new_page = [this, &page_addr] () {
+		_pages.push_back (page_addr);
+		++page_addr.page;
+		return _pages.back ();
+	};
+	auto byte_offset = [this] (const Address &addr) -> std::size_t {
+		return _mem.getWritableIterator (addr) - _mem.getWritablePage (addr).begin ();
+	};
+
+	std::vector<std::vector<Address>> entry_addresses (_entries.size ());
+	for (std::size_t r: roots) {
+		const Macro &macro = *_entries[r].macro;
+		Address start;
+		if (lengths[r] > capacity) {
+			// Large macros start on a new page, and continue on the
+			// following pages.
+			start = new_page ();
+		}
+		else {
+			auto bin = std::find_if (bins.begin (), bins.end (), [&] (const Bin &bin) {
+				return bin.used + lengths[r] <= capacity;
+			});
+			if (bin == bins.end ()) {
+				bins.push_back ({ new_page (), 0 });
+				bin = std::prev (bins.end ());
+			}
+			start = bin->page;
+			if (!_mem.computeOffset (_mem.getWritablePage (start).begin () + bin->used, start))
+				throw std::logic_error ("Unaligned macro position");
+		}
+
+		if (macro.size () == 0) {
+			_addresses[r] = start;
+			continue;
+		}
+		Address expected_start = start;
+		Address next = macro.write (_format, _mem, start, entry_points[r], entry_addresses[r]);
+		if (start.page != expected_start.page || start.offset != expected_start.offset)
+			throw std::logic_error ("Macro was moved while writing the layout");
+		debug.printf ("Macro %zu written at page %u, offset %u\n", r, start.page, start.offset);
+
+		if (lengths[r] > capacity) {
+			while (page_addr.page <= next.page)
+				new_page ();
+			bins.push_back ({ next, byte_offset (next) });
+			bins.back ().page.offset = 0;
+		}
+		else {
+			auto bin = std::find_if (bins.begin (), bins.end (), [&start] (const Bin &bin) {
+				return bin.page.page == start.page;
+			});
+			bin->used = byte_offset (next);
+		}
+	}
+
+	for (std::size_t i = 0; i < _entries.size (); ++i) {
+		const Entry &entry = _entries[i];
+		if (entry.macro->size () == 0) {
+			if (entry.root != i)
+				_addresses[i] = _addresses[entry.root];
+			continue;
+		}
+		const auto &points = entry_points[entry.root];
+		auto point = std::find (points.begin (), points.end (), entry.offset);
+		_addresses[i] = entry_addresses[entry.root][point - points.begin ()];
+	}
+
+	std::sort (_pages.begin (), _pages.end ());
+	debug.printf ("%zu macros stored as %zu in %zu pages\n",
+		      _entries.size (), _stored_count, _pages.size ());
+}
+
+const Address &MacroLayout::address (std::size_t index) const
+{
+	return _addresses.at (index);
+}
+
+const std::vector<Address> &MacroLayout::pages () const
+{
+	return _pages;
+}
+
+std::size_t MacroLayout::storedCount () const
+{
+	return _stored_count;
+}
@@ -0,0 +1,110 @@
+/*
+ * Copyright 2026 Clément Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef LIBHIDPP_HIDPP_MACRO_LAYOUT_H
+#define LIBHIDPP_HIDPP_MACRO_LAYOUT_H
+
+#include <hidpp/Address.h>
+#include <hidpp/Macro.h>
+
+#include <vector>
+#include <cstdint>
+
+namespace HIDPP
+{
+
+class AbstractMacroFormat;
+class AbstractMemoryMapping;
+
+/**
+ * Place a set of macros in memory using as few pages as possible.
+ *
+ * Identical macros are stored once, and a macro that is the tail of
+ * another one is stored inside it (its first item is aligned so that
+ * it can be addressed directly).
+ *
+ * The remaining macros are packed in pages by decreasing size (first
+ * fit) so that, unless it is larger than a page, a macro never spans
+ * two pages. Macros larger than a page are written first at the
+ * beginning of their own pages and the space left after them is used
+ * for the smaller ones.
+ *
+ * \ingroup hidpp
+ */
+class MacroLayout
+{
+public:
+	MacroLayout (const AbstractMacroFormat &format, AbstractMemoryMapping &mem);
+
+	/**
+	 * Add \p macro to the layout.
+	 *
+	 * \p macro is not copied and must stay valid until write() is called.
+	 *
+	 * \returns the index of the macro for address().
+	 */
+	std::size_t add (const Macro &macro);
+
+	/**
+	 * Write every added macro in pages starting from \p first_page
+	 * (the offset is ignored).
+	 */
+	void write (const Address &first_page);
+
+	/**
+	 * \returns the address of the macro \p index after write().
+	 */
+	const Address &address (std::size_t index) const;
+
+	/**
+	 * Pages used by write() in increasing order.
+	 */
+	const std::vector<Address> &pages () const;
+
+	/**
+	 * Number of macros actually written, the others being shared.
+	 */
+	std::size_t storedCount () const;
+
+private:
+	const AbstractMacroFormat &_format;
+	AbstractMemoryMapping &_mem;
+
+	struct Entry {
+		const Macro *macro;
+		/**
+		 * Encoded items (jump destinations are stored relative to
+		 * the item), used for finding identical macros and tails.
+		 */
+		std::vector<std::vector<uint8_t>> items;
+		std::size_t root;	///< Entry storing this macro.
+		std::size_t offset;	///< Index of the first item in the root macro.
+	};
+	std::vector<Entry> _entries;
+	std::vector<Address> _addresses;
+	std::vector<Address> _pages;
+	std::size_t _stored_count;
+
+	std::size_t estimateLength (const Entry &root,
+				    const std::vector<std::size_t> &entry_points,
+				    std::size_t alignment) const;
+};
+
+}
+
+#endif
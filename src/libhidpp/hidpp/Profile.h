@@ -83,9 +83,9 @@ struct Profile
 		} _params;
 	};
 
-	std::map<std::string, Setting> settings;
+	SettingValues settings;
 	std::vector<Button> buttons;
-	std::vector<std::map<std::string, Setting>> modes;
+	std::vector<SettingValues> modes;
 };
 
 }
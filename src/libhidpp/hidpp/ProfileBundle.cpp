@@ -0,0 +1,196 @@
+/*
+ * Copyright 2026 Clément Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ProfileBundle.h"
+
+#include <hidpp/AbstractMemoryMapping.h>
+#include <misc/CRC.h>
+#include <misc/Endian.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace HIDPP;
+
+static constexpr char Magic[4] = { 'H', 'P', 'P', 'B' };
+
+bool ProfileBundle::Target::operator== (const Target &other) const
+{
+	return protocol == other.protocol &&
+		product_id == other.product_id &&
+		profile_format == other.profile_format &&
+		macro_format == other.macro_format &&
+		page_size == other.page_size;
+}
+
+bool ProfileBundle::Target::operator!= (const Target &other) const
+{
+	return !(*this == other);
+}
+
+unsigned int ProfileBundle::deploy (AbstractMemoryMapping &mem, const Target &device,
+				    const Address &device_dir_address, bool verify) const
+{
+	if (target != device)
+		throw std::runtime_error ("Bundle was compiled for a different device");
+	if (dir_address.mem_type != device_dir_address.mem_type ||
+	    dir_address.page != device_dir_address.page ||
+	    dir_address.offset != device_dir_address.offset)
+		throw std::runtime_error ("Bundle directory address does not match the device");
+
+	std::vector<Address> addresses;
+	for (const auto &page: pages)
+		addresses.push_back (page.address);
+	mem.prefetch (addresses);
+
+	unsigned int written = 0;
+	for (const auto &page: pages) {
+		if (mem.getReadOnlyPage (page.address) == page.data)
+			continue;
+		auto &data = mem.getWritablePage (page.address);
+		if (data.size () != page.data.size ())
+			throw std::runtime_error ("Page size does not match the device");
+		data = page.data;
+		mem.commitPage (page.address);
+		++written;
+	}
+	if (verify)
+		mem.syncVerified ();
+	else
+		mem.sync ();
+	return written;
+}
+
+static void pushAddress (std::vector<uint8_t> &buffer, const Address &address)
+{
+	buffer.push_back (address.mem_type);
+	pushBE<uint16_t> (buffer, address.page);
+	pushBE<uint16_t> (buffer, address.offset);
+}
+
+void ProfileBundle::save (std::ostream &stream) const
+{
+	std::vector<uint8_t> buffer (Magic, Magic + sizeof (Magic));
+	pushBE<uint16_t> (buffer, FormatVersion);
+	buffer.push_back (target.protocol);
+	pushBE<uint16_t> (buffer, target.product_id);
+	buffer.push_back (target.profile_format);
+	buffer.push_back (target.macro_format);
+	pushBE<uint16_t> (buffer, target.page_size);
+	pushAddress (buffer, dir_address);
+	pushBE<uint16_t> (buffer, pages.size ());
+	pushBE<uint16_t> (buffer, CRC::CCITT (buffer.begin (), buffer.end ()));
+
+	for (const auto &page: pages) {
+		pushAddress (buffer, page.address);
+		pushBE<uint16_t> (buffer, page.data.size ());
+		pushBE<uint16_t> (buffer, CRC::CCITT (page.data.begin (), page.data.end ()));
+		buffer.insert (buffer.end (), page.data.begin (), page.data.end ());
+	}
+	stream.write (reinterpret_cast<const char *> (buffer.data ()), buffer.size ());
+	if (!stream)
+		throw std::runtime_error ("Failed to write profile bundle");
+}
+
+namespace
+{
+
+class BundleReader
+{
+public:
+	BundleReader (std::istream &stream):
+		_stream (stream)
+	{
+	}
+
+	std::vector<uint8_t> read (std::size_t length)
+	{
+		std::vector<uint8_t> data (length);
+		_stream.read (reinterpret_cast<char *> (data.data ()), length);
+		if (_stream.gcount () != static_cast<std::streamsize> (length))
+			throw std::runtime_error ("Truncated profile bundle");
+		_header.insert (_header.end (), data.begin (), data.end ());
+		return data;
+	}
+
+	template<typename T>
+	T read ()
+	{
+		return readBE<T> (read (sizeof (T)), 0);
+	}
+
+	Address readAddress ()
+	{
+		Address address;
+		address.mem_type = read<uint8_t> ();
+		address.page = read<uint16_t> ();
+		address.offset = read<uint16_t> ();
+		return address;
+	}
+
+	/**
+	 * Bytes read since the last call
+	 */
+	std::vector<uint8_t> consumed ()
+	{
+		return std::move (_header);
+	}
+
+private:
+	std::istream &_stream;
+	std::vector<uint8_t> _header;
+};
+
+}
+
+ProfileBundle ProfileBundle::load (std::istream &stream)
+{
+	BundleReader reader (stream);
+	auto magic = reader.read (sizeof (Magic));
+	if (!std::equal (magic.begin (), magic.end (), Magic))
+		throw std::runtime_error ("Not a profile bundle");
+	if (reader.read<uint16_t> () != FormatVersion)
+		throw std::runtime_error ("Unsupported profile bundle version");
+
+	ProfileBundle bundle;
+	bundle.target.protocol = reader.read<uint8_t> ();
+	bundle.target.product_id = reader.read<uint16_t> ();
+	bundle.target.profile_format = reader.read<uint8_t> ();
+	bundle.target.macro_format = reader.read<uint8_t> ();
+	bundle.target.page_size = reader.read<uint16_t> ();
+	bundle.dir_address = reader.readAddress ();
+	unsigned int page_count = reader.read<uint16_t> ();
+	auto header = reader.consumed ();
+	if (reader.read<uint16_t> () != CRC::CCITT (header.begin (), header.end ()))
+		throw std::runtime_error ("Profile bundle header is corrupted");
+
+	for (unsigned int i = 0; i < page_count; ++i) {
+		Page page;
+		page.address = reader.readAddress ();
+		std::size_t length = reader.read<uint16_t> ();
+		uint16_t crc = reader.read<uint16_t> ();
+		page.data = reader.read (length);
+		if (crc != CRC::CCITT (page.data.begin (), page.data.end ()))
+			throw std::runtime_error ("Profile bundle page is corrupted");
+		if (length != bundle.target.page_size)
+			throw std::runtime_error ("Profile bundle page has the wrong size");
+		reader.consumed ();
+		bundle.pages.push_back (std::move (page));
+	}
+	return bundle;
+}
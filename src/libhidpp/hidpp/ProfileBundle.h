@@ -0,0 +1,109 @@
+/*
+ * Copyright 2026 Clément Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef LIBHIDPP_HIDPP_PROFILE_BUNDLE_H
+#define LIBHIDPP_HIDPP_PROFILE_BUNDLE_H
+
+#include <hidpp/Address.h>
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace HIDPP
+{
+
+class AbstractMemoryMapping;
+
+/**
+ * Pre-encoded profiles ready to be written in a device memory.
+ *
+ * A bundle contains the final page images (profile directory, profiles
+ * and packed macros, with their CRC) for one profile and macro format.
+ * It is compiled once from the XML profiles and can then be deployed on
+ * any device using the same formats without encoding again.
+ *
+ * The bundle file starts with a header ("HPPB" magic, format version,
+ * target description and directory address) followed by the pages,
+ * each with its address, size and CRC-CCITT. All integers are big
+ * endian. The header is also protected by a CRC.
+ *
+ * \ingroup hidpp
+ */
+struct ProfileBundle
+{
+	static constexpr uint16_t FormatVersion = 1;
+
+	/**
+	 * Device the pages were encoded for.
+	 *
+	 * Profile and directory encodings also depend on the model (button
+	 * count, profile count, ...), not only on the format numbers.
+	 */
+	struct Target
+	{
+		uint8_t protocol;	///< HID++ major version.
+		uint16_t product_id;
+		uint8_t profile_format;	///< HID++ 2.0 profile format.
+		uint8_t macro_format;	///< HID++ 2.0 macro format.
+		uint16_t page_size;
+
+		bool operator== (const Target &other) const;
+		bool operator!= (const Target &other) const;
+	};
+	Target target;
+	Address dir_address;
+
+	struct Page
+	{
+		Address address;
+		std::vector<uint8_t> data;
+	};
+	std::vector<Page> pages;
+
+	/**
+	 * Write the pages in \p mem of a device described by \p device
+	 * with its profile directory at \p device_dir_address.
+	 *
+	 * The current pages are read first and only the lines that differ
+	 * are written. With \p verify, they are checked with
+	 * AbstractMemoryMapping::syncVerified. Pages already contain their
+	 * CRC.
+	 *
+	 * \returns the number of pages that were written.
+	 * \throws std::runtime_error if the bundle was compiled for another
+	 * device or directory address, or if a page size does not match \p mem.
+	 */
+	unsigned int deploy (AbstractMemoryMapping &mem, const Target &device,
+			     const Address &device_dir_address, bool verify = false) const;
+
+	/**
+	 * Write the bundle to \p stream.
+	 */
+	void save (std::ostream &stream) const;
+	/**
+	 * Read a bundle from \p stream.
+	 *
+	 * \throws std::runtime_error if the bundle is invalid or corrupted.
+	 */
+	static ProfileBundle load (std::istream &stream);
+};
+
+}
+
+#endif
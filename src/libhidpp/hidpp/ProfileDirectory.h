@@ -30,7 +30,7 @@ struct ProfileDirectory
 	struct Entry
 	{
 		Address profile_address;
-		std::map<std::string, Setting> settings;
+		SettingValues settings;
 	};
 
 	std::vector<Entry> entries;
@@ -0,0 +1,52 @@
+/*
+ * Copyright 2026 Clément Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "ProfilePrefetch.h"
+
+#include <hidpp/AbstractMemoryMapping.h>
+#include <hidpp/AbstractProfileDirectoryFormat.h>
+#include <hidpp/AbstractProfileFormat.h>
+
+using namespace HIDPP;
+
+ProfileDirectory HIDPP::prefetchProfiles (AbstractMemoryMapping &mem,
+					  const AbstractProfileDirectoryFormat &profdir_format,
+					  const AbstractProfileFormat &profile_format,
+					  const Address &dir_address,
+					  std::vector<Profile> &profiles)
+{
+	ProfileDirectory profdir = profdir_format.read (mem.getReadOnlyIterator (dir_address));
+
+	std::vector<Address> profile_pages;
+	for (const auto &entry: profdir.entries)
+		profile_pages.push_back (entry.profile_address);
+	mem.prefetch (profile_pages);
+
+	std::vector<Address> macro_pages;
+	profiles.clear ();
+	for (const auto &entry: profdir.entries) {
+		profiles.push_back (profile_format.read (mem.getReadOnlyIterator (entry.profile_address)));
+		for (const auto &button: profiles.back ().buttons)
+			if (button.type () == Profile::Button::Type::Macro)
+				macro_pages.push_back (button.macro ());
+	}
+	mem.prefetch (macro_pages);
+
+	return profdir;
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright 2026 Clément Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef LIBHIDPP_HIDPP_PROFILE_PREFETCH_H
+#define LIBHIDPP_HIDPP_PROFILE_PREFETCH_H
+
+#include <hidpp/Address.h>
+#include <hidpp/Profile.h>
+#include <hidpp/ProfileDirectory.h>
+
+namespace HIDPP
+{
+
+class AbstractMemoryMapping;
+class AbstractProfileDirectoryFormat;
+class AbstractProfileFormat;
+
+/**
+ * Read the profile directory and prefetch the pages used by its profiles.
+ *
+ * Instead of letting \p mem read pages one by one while decoding, the
+ * pages are fetched in three batches: the directory page, every profile
+ * page, then the first page of every macro referenced by the profile
+ * buttons. Pages only reached by following macro jumps are still read
+ * lazily.
+ *
+ * The profiles are decoded for finding their macros, they are returned
+ * in \p profiles in the same order as the directory entries.
+ *
+ * \returns the decoded profile directory.
+ *
+ * \ingroup hidpp
+ */
+ProfileDirectory prefetchProfiles (AbstractMemoryMapping &mem,
+				   const AbstractProfileDirectoryFormat &profdir_format,
+				   const AbstractProfileFormat &profile_format,
+				   const Address &dir_address,
+				   std::vector<Profile> &profiles);
+
+}
+
+#endif
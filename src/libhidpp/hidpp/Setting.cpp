@@ -27,6 +27,10 @@
 
 using namespace HIDPP;
 
+static_assert (std::is_same<std::variant_alternative_t<static_cast<std::size_t> (Setting::Type::ComposedSetting), Setting::Value>, ComposedSetting>::value &&
+	       std::is_same<std::variant_alternative_t<static_cast<std::size_t> (Setting::Type::Enum), Setting::Value>, EnumValue>::value,
+	       "Setting::Value alternatives must follow Setting::Type order");
+
 template<>
 Setting::Type Setting::type<std::string> ()
 {
@@ -63,78 +67,14 @@ Setting::Type Setting::type<EnumValue> ()
 	return Type::Enum;
 }
 
-Setting::Setting (const Setting &other):
-	_type (other._type)
-{
-	switch (_type) {
-	case Type::String:
-		_value = new std::string (*reinterpret_cast<std::string *> (other._value));
-		break;
-	case Type::Boolean:
-		_value = new bool (*reinterpret_cast<bool *> (other._value));
-		break;
-	case Type::Integer:
-		_value = new int (*reinterpret_cast<int *> (other._value));
-		break;
-	case Type::LEDVector:
-		_value = new LEDVector (*reinterpret_cast<LEDVector *> (other._value));
-		break;
-	case Type::Color:
-		_value = new Color (*reinterpret_cast<Color *> (other._value));
-		break;
-	case Type::ComposedSetting:
-		_value = new ComposedSetting (*reinterpret_cast<ComposedSetting *> (other._value));
-		break;
-	case Type::Enum:
-		_value = new EnumValue (*reinterpret_cast<EnumValue *> (other._value));
-		break;
-	}
-}
-
-Setting::Setting (Setting &&other):
-	_type (other._type),
-	_value (other._value)
-{
-	other._value = nullptr;
-}
-
-Setting::~Setting ()
-{
-	if (!_value)
-		return;
-	switch (_type) {
-	case Type::String:
-		delete reinterpret_cast<std::string *> (_value);
-		break;
-	case Type::Boolean:
-		delete reinterpret_cast<bool *> (_value);
-		break;
-	case Type::Integer:
-		delete reinterpret_cast<int *> (_value);
-		break;
-	case Type::LEDVector:
-		delete reinterpret_cast<LEDVector *> (_value);
-		break;
-	case Type::Color:
-		delete reinterpret_cast<Color *> (_value);
-		break;
-	case Type::ComposedSetting:
-		delete reinterpret_cast<ComposedSetting *> (_value);
-		break;
-	case Type::Enum:
-		delete reinterpret_cast<EnumValue *> (_value);
-		break;
-	}
-}
-
 Setting::Type Setting::type () const
 {
-	return _type;
+	return static_cast<Type> (_value.index ());
 }
 
 std::string Setting::toString () const
 {
-	switch (_type) {
+	switch (type ()) {
 	case Type::String:
 		return get<std::string> ();
 
@@ -170,58 +110,75 @@ std::string Setting::toString () const
 	}
 }
 
-SettingDesc::SettingDesc (const std::string &default_value):
-	_type (Setting::Type::String),
-	_default_value (default_value)
+SettingValues::SettingValues ()
 {
 }
 
-SettingDesc::SettingDesc (bool default_value):
-	_type (Setting::Type::Boolean),
-	_default_value (default_value)
+SettingValues::SettingValues (std::size_t size):
+	_values (size)
 {
 }
 
-SettingDesc::SettingDesc (int min, int max, int default_value):
-	_type (Setting::Type::Integer),
-	_min (min),
-	_max (max),
-	_default_value (default_value)
+std::size_t SettingValues::size () const
 {
+	return _values.size ();
 }
 
-SettingDesc::SettingDesc (const LEDVector &default_value):
-	_type (Setting::Type::LEDVector),
-	_led_count (default_value.size ()),
-	_default_value (default_value)
+const Setting *SettingValues::find (std::size_t index) const
+{
+	if (index >= _values.size () || !_values[index])
+		return nullptr;
+	return &*_values[index];
+}
+
+Setting *SettingValues::find (std::size_t index)
 {
+	if (index >= _values.size () || !_values[index])
+		return nullptr;
+	return &*_values[index];
 }
 
-SettingDesc::SettingDesc (const Color &default_value):
-	_type (Setting::Type::Color),
-	_default_value (default_value)
+bool SettingValues::has (std::size_t index) const
 {
+	return find (index) != nullptr;
 }
 
-SettingDesc::SettingDesc (std::initializer_list<container::value_type> sub_settings):
-	_type (Setting::Type::ComposedSetting),
-	_sub_settings (sub_settings),
-	_default_value (ComposedSetting ())
+const Setting &SettingValues::at (std::size_t index) const
 {
+	if (auto value = find (index))
+		return *value;
+	throw std::out_of_range ("setting is not set");
 }
 
-SettingDesc::SettingDesc (const container &sub_settings):
-	_type (Setting::Type::ComposedSetting),
-	_sub_settings (sub_settings),
-	_default_value (ComposedSetting ())
+Setting &SettingValues::at (std::size_t index)
 {
+	if (auto value = find (index))
+		return *value;
+	throw std::out_of_range ("setting is not set");
 }
 
-SettingDesc::SettingDesc (const EnumDesc &enum_desc, int default_value):
-	_type (Setting::Type::Enum),
-	_enum_desc (&enum_desc),
-	_default_value (EnumValue (enum_desc, default_value))
+void SettingValues::set (std::size_t index, Setting value)
 {
+	if (index >= _values.size ())
+		_values.resize (index+1);
+	_values[index] = std::move (value);
+}
+
+void SettingValues::reset (std::size_t index)
+{
+	if (index < _values.size ())
+		_values[index].reset ();
+}
+
+SettingDesc::SettingDesc (const LEDVector &default_value):
+	SettingDesc (Setting::Type::LEDVector)
+{
+	if (default_value.size () > 32)
+		throw std::invalid_argument ("too many LEDs");
+	_led_count = default_value.size ();
+	for (unsigned int i = 0; i < _led_count; ++i)
+		if (default_value[i])
+			_default_int |= 1<<i;
 }
 
 bool SettingDesc::check (const Setting &setting) const
@@ -246,19 +203,24 @@ bool SettingDesc::check (const Setting &setting) const
 		EnumValue value = setting.get<EnumValue> ();
 		return &value.desc () == _enum_desc && _enum_desc->check (value.get ());
 	}
-	case Setting::Type::ComposedSetting:
-		for (const auto &pair: setting.get<ComposedSetting> ()) {
-			auto it = _sub_settings.find (pair.first);
-			if (it == _sub_settings.end ()) {
-				Log::debug () << "Unknwon sub-setting: " << pair.first << std::endl;
+	case Setting::Type::ComposedSetting: {
+		const auto &values = setting.get<ComposedSetting> ();
+		for (std::size_t i = 0; i < values.size (); ++i) {
+			const Setting *value = values.find (i);
+			if (!value)
+				continue;
+			if (!_sub_settings->available (i)) {
+				Log::debug () << "Unknwon sub-setting: " << i << std::endl;
 				return false;
 			}
-			if (!it->second.check (pair.second)) {
-				Log::debug () << "Sub-setting \"" << pair.first << "\" is not valid." << std::endl;
+			const auto &entry = (*_sub_settings)[i];
+			if (!entry.desc.check (*value)) {
+				Log::debug () << "Sub-setting \"" << entry.name << "\" is not valid." << std::endl;
 				return false;
 			}
 		}
 		return true;
+	}
 	default:
 		return false;
 	}
@@ -322,7 +284,35 @@ Setting SettingDesc::convertFromString (const std::string &str) const
 
 Setting SettingDesc::defaultValue () const
 {
-	return _default_value;
+	switch (_type) {
+	case Setting::Type::String:
+		return std::string (_default_string);
+
+	case Setting::Type::Boolean:
+		return _default_int != 0;
+
+	case Setting::Type::Integer:
+		return _default_int;
+
+	case Setting::Type::LEDVector: {
+		LEDVector leds;
+		for (unsigned int i = 0; i < _led_count; ++i)
+			leds.push_back (_default_int & 1<<i);
+		return leds;
+	}
+
+	case Setting::Type::Color:
+		return _default_color;
+
+	case Setting::Type::ComposedSetting:
+		return ComposedSetting ();
+
+	case Setting::Type::Enum:
+		return EnumValue (*_enum_desc, _default_int);
+
+	default:
+		throw std::logic_error ("invalid type");
+	}
 }
 
 Setting::Type SettingDesc::type () const
@@ -353,18 +343,29 @@ bool SettingDesc::isComposed () const
 	return _type == Setting::Type::ComposedSetting;
 }
 
-SettingDesc::const_iterator SettingDesc::find (const std::string &name) const
+const SettingSchema &SettingDesc::subSettings () const
 {
-	return _sub_settings.find (name);
+	assert (_type == Setting::Type::ComposedSetting);
+	return *_sub_settings;
 }
 
-SettingDesc::const_iterator SettingDesc::begin () const
+bool SettingSchema::available (std::size_t index) const
 {
-	return _sub_settings.begin ();
+	return index < _size && (_available & uint64_t (1) << index);
 }
 
-SettingDesc::const_iterator SettingDesc::end () const
+SettingSchema SettingSchema::without (std::size_t index) const
 {
-	return _sub_settings.end ();
+	SettingSchema schema = *this;
+	if (index < _size)
+		schema._available &= ~(uint64_t (1) << index);
+	return schema;
 }
 
+std::size_t SettingSchema::find (const std::string &name) const
+{
+	for (std::size_t i = 0; i < _size; ++i)
+		if (available (i) && name == _entries[i].name)
+			return i;
+	return npos;
+}
@@ -21,7 +21,11 @@
 
 #include <vector>
 #include <map>
+#include <optional>
 #include <stdexcept>
+#include <string>
+#include <variant>
+#include <cstdint>
 
 #include <hidpp/Enum.h>
 
@@ -36,10 +40,54 @@ struct Color
 typedef std::vector<bool> LEDVector;
 
 class Setting;
-typedef std::map<std::string, Setting> ComposedSetting;
 
-//typedef std::variant<std::string, bool, int, LEDVector, Color, ComposedSetting, EnumValue> Setting;
+/**
+ * Setting values indexed by the position of their description in a
+ * SettingSchema.
+ *
+ * Values that are not set use the default value from their description.
+ */
+class SettingValues
+{
+public:
+	SettingValues ();
+	explicit SettingValues (std::size_t size);
+
+	std::size_t size () const;
+
+	/**
+	 * Get the value at \p index, or nullptr if it is not set.
+	 */
+	const Setting *find (std::size_t index) const;
+	Setting *find (std::size_t index);
+	bool has (std::size_t index) const;
+	/**
+	 * Get the value at \p index.
+	 *
+	 * \throws std::out_of_range if the value is not set.
+	 */
+	const Setting &at (std::size_t index) const;
+	Setting &at (std::size_t index);
+
+	/**
+	 * Set the value at \p index, the array grows if needed.
+	 */
+	void set (std::size_t index, Setting value);
+	void reset (std::size_t index);
+
+private:
+	std::vector<std::optional<Setting>> _values;
+};
 
+typedef SettingValues ComposedSetting;
+
+/**
+ * Value of a setting.
+ *
+ * Values are stored in a variant: scalars, colors and enum values are kept
+ * inline, without any allocation. The order of the variant alternatives
+ * must match Type.
+ */
 class Setting
 {
 public:
@@ -53,6 +101,8 @@ public:
 		Enum,
 	};
 
+	typedef std::variant<std::string, bool, int, LEDVector, Color, ComposedSetting, EnumValue> Value;
+
 	template<typename T> static Type type ();
 
 	template<typename T>
@@ -63,36 +113,35 @@ public:
 
 	template<typename T>
 	Setting (T value):
-		_type (type<typename base_type<T>::type> ()),
-		_value (new typename base_type<T>::type (value))
+		_value (std::in_place_type<typename base_type<T>::type>, std::move (value))
 	{
 	}
 
-	Setting (const Setting &other);
-	Setting (Setting &&other);
+	Setting (const Setting &other) = default;
+	Setting (Setting &&other) = default;
 
-	~Setting ();
+	Setting &operator= (const Setting &other) = default;
+	Setting &operator= (Setting &&other) = default;
 
 	Type type () const;
 
 	template<typename T>
 	const T &get () const {
-		if (_type != type<T> ())
-			throw std::runtime_error ("Invalid type");
-		return *reinterpret_cast<T *> (_value);
+		if (auto value = std::get_if<T> (&_value))
+			return *value;
+		throw std::runtime_error ("Invalid type");
 	}
 
 	template<typename T>
 	T &get () {
-		if (_type != type<T> ())
-			throw std::runtime_error ("Invalid type");
-		return *reinterpret_cast<T *> (_value);
+		if (auto value = std::get_if<T> (&_value))
+			return *value;
+		throw std::runtime_error ("Invalid type");
 	}
 
 	std::string toString () const;
 private:
-	Type _type;
-	void *_value;
+	Value _value;
 };
 
 template<> Setting::Type Setting::type<std::string> ();
@@ -103,20 +152,64 @@ template<> Setting::Type Setting::type<Color> ();
 template<> Setting::Type Setting::type<ComposedSetting> ();
 template<> Setting::Type Setting::type<EnumValue> ();
 
+class SettingSchema;
+
+/**
+ * Description of a setting: its type, valid values and default value.
+ *
+ * Except for LED vectors, descriptions are literal types so that schemas
+ * can be built as constant tables.
+ */
 class SettingDesc
 {
 public:
-	typedef std::map<std::string, SettingDesc> container;
-	typedef container::const_iterator const_iterator;
+	constexpr SettingDesc (const char *default_value):
+		SettingDesc (Setting::Type::String)
+	{
+		_default_string = default_value;
+	}
+
+	constexpr SettingDesc (bool default_value):
+		SettingDesc (Setting::Type::Boolean)
+	{
+		_default_int = default_value;
+	}
 
-	SettingDesc (const std::string &default_value);
-	SettingDesc (bool default_value);
-	SettingDesc (int min, int max, int default_value);
+	constexpr SettingDesc (int min, int max, int default_value):
+		SettingDesc (Setting::Type::Integer)
+	{
+		_min = min;
+		_max = max;
+		_default_int = default_value;
+	}
+
+	/**
+	 * LED vectors with up to 32 LEDs.
+	 */
 	SettingDesc (const LEDVector &default_value);
-	SettingDesc (const Color &default_value);
-	SettingDesc (std::initializer_list<container::value_type> sub_settings);
-	SettingDesc (const container &sub_settings);
-	SettingDesc (const EnumDesc &enum_desc, int default_value);
+
+	constexpr SettingDesc (const Color &default_value):
+		SettingDesc (Setting::Type::Color)
+	{
+		_default_color = default_value;
+	}
+
+	/**
+	 * Composed setting using the sub-settings from \p sub_settings, which
+	 * must outlive this description.
+	 */
+	constexpr SettingDesc (const SettingSchema &sub_settings):
+		SettingDesc (Setting::Type::ComposedSetting)
+	{
+		_sub_settings = &sub_settings;
+	}
+
+	constexpr SettingDesc (const EnumDesc &enum_desc, int default_value):
+		SettingDesc (Setting::Type::Enum)
+	{
+		_enum_desc = &enum_desc;
+		_default_int = default_value;
+	}
 
 	bool check (const Setting &setting) const;
 
@@ -129,17 +222,96 @@ public:
 	const EnumDesc &enumDesc () const;
 
 	bool isComposed () const;
-	const_iterator begin () const;
-	const_iterator end () const;
-	const_iterator find (const std::string &name) const;
+	const SettingSchema &subSettings () const;
 
 private:
+	constexpr SettingDesc (Setting::Type type):
+		_type (type),
+		_min (0), _max (0),
+		_default_int (0),
+		_default_color { 0, 0, 0 },
+		_default_string (nullptr),
+		_led_count (0),
+		_sub_settings (nullptr),
+		_enum_desc (nullptr)
+	{
+	}
+
 	Setting::Type _type;
 	int _min, _max;
+	int _default_int; ///< Default for booleans, integers, enums and LED bits.
+	Color _default_color;
+	const char *_default_string;
 	unsigned int _led_count;
-	container _sub_settings;
+	const SettingSchema *_sub_settings;
 	const EnumDesc *_enum_desc;
-	Setting _default_value;
+};
+
+/**
+ * Ordered list of setting names and descriptions.
+ *
+ * A schema is a view on a constant table of entries. Formats refer to
+ * their settings by their index in the table, names are only used for
+ * converting from and to text (e.g. XML profiles). Entries can be marked
+ * unavailable for devices that do not support them without changing the
+ * other indexes.
+ */
+class SettingSchema
+{
+public:
+	struct Entry
+	{
+		const char *name;
+		SettingDesc desc;
+	};
+
+	static constexpr std::size_t MaxSize = 64;
+	static constexpr std::size_t npos = static_cast<std::size_t> (-1);
+
+	template<std::size_t N>
+	constexpr SettingSchema (const Entry (&entries)[N]):
+		SettingSchema (entries, N)
+	{
+		static_assert (N <= MaxSize, "too many settings in schema");
+	}
+
+	/**
+	 * \p size must not be more than MaxSize.
+	 */
+	constexpr SettingSchema (const Entry *entries, std::size_t size):
+		_entries (entries),
+		_size (size),
+		_available (size == MaxSize ? ~uint64_t (0) : (uint64_t (1) << size) - 1)
+	{
+	}
+
+	constexpr std::size_t size () const
+	{
+		return _size;
+	}
+
+	constexpr const Entry &operator[] (std::size_t index) const
+	{
+		return _entries[index];
+	}
+
+	bool available (std::size_t index) const;
+	/**
+	 * Copy of this schema with the setting at \p index unavailable.
+	 */
+	SettingSchema without (std::size_t index) const;
+
+	/**
+	 * Find the index of the available setting called \p name.
+	 *
+	 * \returns the index or npos if there is no such setting.
+	 */
+	std::size_t find (const std::string &name) const;
+
+private:
+	const Entry *_entries;
+	std::size_t _size;
+	uint64_t _available;
 };
 
 }
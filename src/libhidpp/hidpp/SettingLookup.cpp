@@ -20,8 +20,8 @@
 
 using namespace HIDPP;
 
-SettingLookup::SettingLookup (const std::map<std::string, Setting> &values, const std::map<std::string, SettingDesc> &descs):
+SettingLookup::SettingLookup (const SettingValues &values, const SettingSchema &schema):
 	_values (values),
-	_descs (descs)
+	_schema (schema)
 {
 }
@@ -25,46 +25,49 @@
 namespace HIDPP
 {
 
+/**
+ * Get checked setting values, or their defaults, by their index in a schema.
+ */
 class SettingLookup
 {
 public:
-	SettingLookup (const std::map<std::string, Setting> &values, const std::map<std::string, SettingDesc> &descs);
+	SettingLookup (const SettingValues &values, const SettingSchema &schema);
 
 	template<typename T>
-	T get (const std::string &name)
+	T get (std::size_t index)
 	{
-		const SettingDesc &desc = _descs.at (name);
-		auto it = _values.find (name);
-		if (it == _values.end ())
+		const SettingDesc &desc = _schema[index].desc;
+		const Setting *value = _values.find (index);
+		if (!value)
 			return desc.defaultValue ().get<T> ();
-		if (!desc.check (it->second)) {
-			Log::error () << "Invalid value in setting \"" << name
+		if (!desc.check (*value)) {
+			Log::error () << "Invalid value in setting \"" << _schema[index].name
 				      << "\", using default value instead."
 				      << std::endl;
 			return desc.defaultValue ().get<T> ();
 		}
-		return it->second.get<T> ();
+		return value->get<T> ();
 	}
 
 	template<typename T>
-	T get (const std::string &name, T default_value)
+	T get (std::size_t index, T default_value)
 	{
-		const SettingDesc &desc = _descs.at (name);
-		auto it = _values.find (name);
-		if (it == _values.end ())
+		const SettingDesc &desc = _schema[index].desc;
+		const Setting *value = _values.find (index);
+		if (!value)
 			return default_value;
-		if (!desc.check (it->second)) {
-			Log::error () << "Invalid value in setting \"" << name
+		if (!desc.check (*value)) {
+			Log::error () << "Invalid value in setting \"" << _schema[index].name
 				      << "\", using default value instead."
 				      << std::endl;
 			return default_value;
 		}
-		return it->second.get<T> ();
+		return value->get<T> ();
 	}
 
 private:
-	const std::map<std::string, Setting> &_values;
-	const std::map<std::string, SettingDesc> &_descs;
+	const SettingValues &_values;
+	SettingSchema _schema;
 };
 
 }
@@ -20,11 +20,19 @@
 
 #include <hidpp10/Device.h>
 #include <hidpp10/defs.h>
+#include <hidpp10/WriteError.h>
 
+#include <hidpp/CommandPipeline.h>
+#include <hidpp/Dispatcher.h>
 #include <misc/Endian.h>
+#include <misc/Log.h>
 
 #include <algorithm>
+#include <deque>
+#include <mutex>
+#include <optional>
 #include <stdexcept>
+#include <tuple>
 
 using namespace HIDPP;
 using namespace HIDPP10;
@@ -46,77 +54,208 @@ int IMemory::readSome (Address address, uint8_t *buffer, std::size_t maxlen)
 	return len;
 }
 
-void IMemory::readMem (Address address, std::vector<uint8_t> &data)
+void IMemory::readMem (Address address, std::vector<uint8_t> &data, unsigned int window)
 {
-	std::size_t read = 0;
-	while (read < data.size ()) {
-		std::size_t len = readSome (address, &data[read], data.size () - read);
-		address.offset += len/2;
-		read += len;
+	std::vector<std::vector<uint8_t>> blocks (1);
+	blocks.front ().swap (data);
+	readMem ({ address }, blocks, window);
+	data.swap (blocks.front ());
+}
+
+void IMemory::readMem (const std::vector<Address> &addresses,
+		       std::vector<std::vector<uint8_t>> &data, unsigned int window)
+{
+	if (addresses.size () != data.size ())
+		throw std::logic_error ("address and data counts differ");
+	// Map each request index to its block and byte offset in the block
+	std::vector<std::tuple<std::size_t, std::size_t>> chunks;
+	for (std::size_t i = 0; i < data.size (); ++i)
+		for (std::size_t read = 0; read < data[i].size (); read += LongParamLength)
+			chunks.emplace_back (i, read);
+	sendPipelinedCommands (_dev->dispatcher (), window, chunks.size (),
+		[&] (std::size_t i) {
+			auto [block, read] = chunks[i];
+			HIDPP::Report request (HIDPP::Report::Short, _dev->deviceIndex (),
+					       GetRegisterLong, MemoryRead);
+			auto params = request.parameterBegin ();
+			params[0] = addresses[block].page;
+			params[1] = addresses[block].offset + read/2;
+			return request;
+		},
+		[&] (std::size_t i, HIDPP::Report &&response) {
+			auto [block, read] = chunks[i];
+			if (response.type () != HIDPP::Report::Long)
+				throw std::runtime_error ("Invalid result length");
+			std::size_t len = std::min (LongParamLength, data[block].size () - read);
+			std::copy_n (response.parameterBegin (), len, &data[block][read]);
+		});
+}
+
+namespace
+{
+
+/*
+ * Queue of SendDataAcknowledgement notifications.
+ *
+ * A persistent handler collects every acknowledgement so that none is
+ * lost between two waits when using DispatcherThread. With
+ * SimpleDispatcher, handlers are only called while reading reports, so
+ * get () also waits on a notification to pump the dispatcher.
+ */
+class AckQueue
+{
+public:
+	AckQueue (HIDPP10::Device *dev):
+		_dev (dev)
+	{
+		_listener = _dev->dispatcher ()->registerEventHandler (
+				_dev->deviceIndex (), SendDataAcknowledgement,
+				[this] (const HIDPP::Report &report) {
+					std::unique_lock<std::mutex> lock (_mutex);
+					_acks.push_back (report);
+					return true;
+				});
+	}
+
+	~AckQueue ()
+	{
+		_dev->dispatcher ()->unregisterEventHandler (_listener);
+	}
+
+	HIDPP::Report get (int timeout)
+	{
+		// Register the notification before checking the queue, so an
+		// acknowledgement arriving in between is not missed.
+		auto notification = _dev->dispatcher ()->getNotification (
+				_dev->deviceIndex (), SendDataAcknowledgement);
+		if (auto ack = pop ())
+			return *ack;
+		notification->get (timeout);
+		if (auto ack = pop ())
+			return *ack;
+		throw std::logic_error ("acknowledgement was not queued");
+	}
+
+private:
+	std::optional<HIDPP::Report> pop ()
+	{
+		std::unique_lock<std::mutex> lock (_mutex);
+		if (_acks.empty ())
+			return std::nullopt;
+		auto ack = std::move (_acks.front ());
+		_acks.pop_front ();
+		return ack;
 	}
+
+	HIDPP10::Device *_dev;
+	HIDPP::Dispatcher::listener_iterator _listener;
+	std::mutex _mutex;
+	std::deque<HIDPP::Report> _acks;
+};
+
 }
 
-void IMemory::writeMem (Address address, const std::vector<uint8_t> &data)
+void IMemory::writeMem (Address address, const std::vector<uint8_t> &data, unsigned int window)
 {
 	static constexpr std::size_t HeaderLength = 9;
 	static constexpr std::size_t FirstPacketDataLength =
 			LongParamLength - HeaderLength;
 
+	/*
+	 * Split data in packets
+	 */
+	struct Packet {
+		uint8_t sub_id;
+		std::vector<uint8_t> params;
+	};
+	std::vector<Packet> packets;
+	if (!data.empty ()) {
+		std::vector<uint8_t> params (LongParamLength);
+		/* First packet header */
+		params[0] = 0x01; // Unknown meaning
+		params[1] = address.page;
+		params[2] = address.offset;
+		writeBE<uint16_t> (params, 5, data.size ());
+		/* Start of data */
+		std::size_t len = std::min (FirstPacketDataLength, data.size ());
+		std::copy_n (data.begin (), len, params.begin () + HeaderLength);
+		packets.push_back ({ SendDataBeginAck, std::move (params) });
+	}
+	for (std::size_t sent = FirstPacketDataLength; sent < data.size (); sent += LongParamLength) {
+		auto it = data.begin () + sent;
+		std::size_t len = std::min (LongParamLength, data.size () - sent);
+		packets.push_back ({ SendDataContinueAck, std::vector<uint8_t> (it, it + len) });
+	}
+	if (packets.size () > 256)
+		throw std::logic_error ("too many data packets");
+
 	/*
 	 * Init sequence number
 	 */
 	resetSequenceNumber ();
 
+	if (window <= 1) {
+		for (std::size_t i = 0; i < packets.size (); ++i)
+			_dev->sendDataPacket (packets[i].sub_id, i,
+					      packets[i].params.begin (), packets[i].params.end (),
+					      true);
+		return;
+	}
+
 	/*
-	 * Start sending packets
+	 * Stream packets, keeping up to window packets waiting for their
+	 * acknowledgement. When a packet fails, the acknowledgements of the
+	 * packets sent after it are drained and the whole transfer restarts
+	 * from the header packet with a new sequence, since the device
+	 * state after an error is unknown.
 	 */
-	bool first = true;
-	std::size_t sent = 0;
-	uint8_t seq_num = 0;
-	while (sent < data.size ()) {
-		if (first) {
-			std::vector<uint8_t> params (LongParamLength);
-			/* First packet header */
-			params[0] = 0x01; // Unknown meaning
-			params[1] = address.page;
-			params[2] = address.offset;
-			writeBE<uint16_t> (params, 5, data.size ());
-			/* Start of data */
-			if (data.size () < FirstPacketDataLength) {
-				std::copy (data.begin (), data.end (),
-					   params.begin () + HeaderLength);
-				sent = data.size ();
-			}
-			else {
-				std::size_t len = std::min (FirstPacketDataLength, data.size ());
-				std::copy_n (data.begin (), len,
-					     params.begin () + HeaderLength);
-				sent += len;
+	static constexpr int AckTimeout = 2000; // ms
+	static constexpr unsigned int MaxRetries = 3;
+	auto debug = Log::debug ("data");
+	AckQueue acks (_dev);
+	std::size_t next = 0, acked = 0;
+	unsigned int retries = 0;
+	while (acked < packets.size ()) {
+		while (next < packets.size () && next - acked < window) {
+			_dev->sendDataPacket (packets[next].sub_id, next,
+					      packets[next].params.begin (), packets[next].params.end (),
+					      false);
+			++next;
+		}
+		auto ack = acks.get (AckTimeout);
+		uint8_t seq_num = ack.parameterBegin ()[0];
+		if (ack.address () == 1) {
+			if (seq_num == static_cast<uint8_t> (acked)) {
+				debug.printf ("Data packet %hhu acknowledged\n", seq_num);
+				++acked;
 			}
-			_dev->sendDataPacket (SendDataBeginAck, seq_num,
-					      params.begin (), params.end (),
-					      true);
-			first = false;
+			else
+				debug.printf ("Ignored acknowledgement for data packet %hhu\n", seq_num);
+			continue;
 		}
-		else {
-			auto it = data.begin () + sent;
-			std::size_t len = std::min (LongParamLength, data.size () - sent);
-			_dev->sendDataPacket (SendDataContinueAck, seq_num,
-					      it, it + len,
-					      true);
-			sent += len;
+		debug.printf ("Data packet %zu: error 0x%02hhx\n", acked, ack.address ());
+		if (++retries > MaxRetries)
+			throw WriteError (ack.address ());
+		for (std::size_t i = acked + 1; i < next; ++i) {
+			try {
+				acks.get (AckTimeout);
+			}
+			catch (HIDPP::Dispatcher::TimeoutError &e) {
+				break;
+			}
 		}
-		seq_num++;
+		resetSequenceNumber ();
+		next = acked = 0;
 	}
 }
 
-void IMemory::writePage (uint8_t page, const std::vector<uint8_t> &data)
+void IMemory::writePage (uint8_t page, const std::vector<uint8_t> &data, unsigned int window)
 {
 	if (data.size () > 512)
 		throw std::logic_error ("page too big");
 
 	fillPage (page);
-	writeMem ({0, page, 0}, data);
+	writeMem ({0, page, 0}, data, window);
 }
 
 void IMemory::resetSequenceNumber ()
@@ -40,11 +40,36 @@ public:
 	IMemory (Device *dev);
 
 	int readSome (HIDPP::Address address, uint8_t *buffer, std::size_t maxlen);
-	void readMem (HIDPP::Address address, std::vector<uint8_t> &data);
+	/**
+	 * Fill \p data with memory starting at \p address.
+	 *
+	 * Up to \p window MemoryRead requests are kept in flight.
+	 *
+	 * \see HIDPP::sendPipelinedCommands
+	 */
+	void readMem (HIDPP::Address address, std::vector<uint8_t> &data, unsigned int window = 1);
+	/**
+	 * Read several memory blocks in a single pipeline.
+	 *
+	 * Each element of \p data is filled with memory starting at the
+	 * address with the same index in \p addresses.
+	 */
+	void readMem (const std::vector<HIDPP::Address> &addresses,
+		      std::vector<std::vector<uint8_t>> &data, unsigned int window = 1);
 
 
-	void writeMem (HIDPP::Address address, const std::vector<uint8_t> &data);
-	void writePage (uint8_t page, const std::vector<uint8_t> &data);
+	/**
+	 * Write \p data to memory starting at \p address.
+	 *
+	 * Data is sent in acknowledged data packets. With a \p window
+	 * greater than 1, up to \p window packets are sent before waiting
+	 * for their acknowledgements and the whole transfer is restarted
+	 * when the device reports a write error. This is not tested with
+	 * every device, the default window of 1 is the usual sequential
+	 * transfer.
+	 */
+	void writeMem (HIDPP::Address address, const std::vector<uint8_t> &data, unsigned int window = 1);
+	void writePage (uint8_t page, const std::vector<uint8_t> &data, unsigned int window = 1);
 
 	void resetSequenceNumber ();
 	void fillPage (uint8_t page);
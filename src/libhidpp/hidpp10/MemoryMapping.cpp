@@ -21,6 +21,8 @@
 #include <hidpp10/defs.h>
 #include <misc/Log.h>
 
+#include <stdexcept>
+
 using namespace HIDPP;
 using namespace HIDPP10;
 
@@ -31,6 +33,11 @@ MemoryMapping::MemoryMapping (Device *dev, bool write_crc):
 {
 }
 
+MemoryMapping::~MemoryMapping ()
+{
+	stopStreaming ();
+}
+
 std::vector<uint8_t>::const_iterator MemoryMapping::getReadOnlyIterator (const Address &address)
 {
 	auto &page = getReadOnlyPage (address);
@@ -56,10 +63,35 @@ bool MemoryMapping::computeOffset (std::vector<uint8_t>::const_iterator it, Addr
 void MemoryMapping::readPage (const Address &address, std::vector<uint8_t> &data)
 {
 	data.resize (PageSize);
-	_imem.readMem (address, data);
+	_imem.readMem (address, data, readWindow ());
+}
+
+void MemoryMapping::readPages (const std::vector<Address> &addresses, std::vector<std::vector<uint8_t>> &data)
+{
+	for (auto &page: data)
+		page.resize (PageSize);
+	_imem.readMem (addresses, data, readWindow ());
+}
+
+void MemoryMapping::readPageRanges (const Address &address, std::vector<uint8_t> &data,
+				    const std::vector<Range> &ranges)
+{
+	std::vector<Address> addresses;
+	std::vector<std::vector<uint8_t>> results;
+	for (const auto &range: ranges) {
+		if (range.first % 2 != 0)
+			throw std::logic_error ("unaligned memory range");
+		addresses.push_back ({ address.mem_type, address.page,
+				       static_cast<unsigned int> (range.first/2) });
+		results.emplace_back (range.second - range.first);
+	}
+	_imem.readMem (addresses, results, readWindow ());
+	for (std::size_t i = 0; i < ranges.size (); ++i)
+		std::copy (results[i].begin (), results[i].end (),
+			   data.begin () + ranges[i].first);
 }
 
 void MemoryMapping::writePage (const Address &address, const std::vector<uint8_t> &data)
 {
-	_imem.writePage (address.page, data);
+	_imem.writePage (address.page, data, writeWindow ());
 }
@@ -0,0 +1,195 @@
+/*
+ * Copyright 2026 Clément Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "PresenceTracker.h"
+
+#include <hidpp10/Device.h>
+#include <hidpp10/Error.h>
+#include <hidpp10/defs.h>
+#include <misc/Endian.h>
+#include <misc/Log.h>
+
+using namespace HIDPP10;
+
+enum ConnectionFlags: uint8_t {
+	DeviceTypeMask = 0x0F,
+	LinkNotEstablished = 1<<6,
+};
+
+enum DisconnectionType: uint8_t {
+	DeviceUnpaired = 0x02,
+};
+
+enum NotificationFlags: uint8_t {
+	WirelessNotifications = 1<<0, // in the second byte of the register
+};
+
+enum ConnectionStateAction: uint8_t {
+	NotifyConnectedDevices = 0x02,
+};
+
+PresenceTracker::PresenceTracker (Device *receiver):
+	_receiver (receiver)
+{
+	for (auto &state: _states)
+		state = DeviceState { false, Link::Unknown, IReceiver::Unknown, 0, {} };
+	auto dispatcher = _receiver->dispatcher ();
+	for (unsigned int i = 1; i <= SlotCount; ++i) {
+		auto index = static_cast<HIDPP::DeviceIndex> (i);
+		_listeners.push_back (dispatcher->registerEventHandler (index, DeviceConnection,
+				std::bind (&PresenceTracker::connectionEvent, this, std::placeholders::_1)));
+		_listeners.push_back (dispatcher->registerEventHandler (index, DeviceDisconnection,
+				std::bind (&PresenceTracker::disconnectionEvent, this, std::placeholders::_1)));
+	}
+}
+
+PresenceTracker::~PresenceTracker ()
+{
+	auto dispatcher = _receiver->dispatcher ();
+	for (auto it: _listeners)
+		dispatcher->unregisterEventHandler (it);
+}
+
+void PresenceTracker::refresh ()
+{
+	IReceiver ireceiver (_receiver);
+	for (unsigned int i = 0; i < SlotCount; ++i) {
+		DeviceState state = { false, Link::Unknown, IReceiver::Unknown, 0, std::chrono::steady_clock::now () };
+		try {
+			ireceiver.getDeviceInformation (i, nullptr, nullptr, &state.wpid, &state.type);
+			state.paired = true;
+		}
+		catch (Error &e) {
+			if (e.errorCode () != Error::InvalidValue)
+				throw;
+		}
+		std::unique_lock<std::mutex> lock (_mutex);
+		auto &current = _states[i];
+		// Keep the link state if it is still the same device.
+		if (state.paired && current.paired && current.wpid == state.wpid)
+			state.link = current.link;
+		current = state;
+	}
+
+	std::vector<uint8_t> params (HIDPP::ShortParamLength);
+	_receiver->getRegister (EnableNotifications, nullptr, params);
+	if (!(params[1] & WirelessNotifications)) {
+		params[1] |= WirelessNotifications;
+		_receiver->setRegister (EnableNotifications, params, nullptr);
+	}
+
+	// The receiver answers with a connection notification for each connected device.
+	std::fill (params.begin (), params.end (), 0);
+	params[0] = NotifyConnectedDevices;
+	_receiver->setRegister (ConnectionState, params, nullptr);
+}
+
+PresenceTracker::DeviceState PresenceTracker::state (HIDPP::DeviceIndex index) const
+{
+	std::unique_lock<std::mutex> lock (_mutex);
+	return slot (index);
+}
+
+bool PresenceTracker::isOnline (HIDPP::DeviceIndex index) const
+{
+	std::unique_lock<std::mutex> lock (_mutex);
+	const auto &state = slot (index);
+	return state.paired && state.link == Link::Established;
+}
+
+bool PresenceTracker::isOffline (HIDPP::DeviceIndex index) const
+{
+	std::unique_lock<std::mutex> lock (_mutex);
+	const auto &state = slot (index);
+	return !state.paired || state.link == Link::NotEstablished;
+}
+
+std::vector<HIDPP::DeviceIndex> PresenceTracker::onlineDevices () const
+{
+	std::unique_lock<std::mutex> lock (_mutex);
+	std::vector<HIDPP::DeviceIndex> devices;
+	for (unsigned int i = 0; i < SlotCount; ++i)
+		if (_states[i].paired && _states[i].link == Link::Established)
+			devices.push_back (static_cast<HIDPP::DeviceIndex> (i+1));
+	return devices;
+}
+
+bool PresenceTracker::waitForConnection (HIDPP::DeviceIndex index, int timeout)
+{
+	auto deadline = std::chrono::steady_clock::now () + std::chrono::milliseconds (timeout);
+	auto dispatcher = _receiver->dispatcher ();
+	while (true) {
+		// Register before checking the state so that no event is missed.
+		auto notification = dispatcher->getNotification (index, DeviceConnection);
+		if (isOnline (index))
+			return true;
+		auto remaining = std::chrono::duration_cast<std::chrono::milliseconds> (
+				deadline - std::chrono::steady_clock::now ()).count ();
+		if (remaining <= 0)
+			return false;
+		try {
+			auto report = notification->get (remaining);
+			if (!(report.parameterBegin ()[0] & LinkNotEstablished))
+				return true;
+		}
+		catch (HIDPP::Dispatcher::TimeoutError &e) {
+			return false;
+		}
+	}
+}
+
+bool PresenceTracker::connectionEvent (const HIDPP::Report &report)
+{
+	auto params = report.parameterBegin ();
+	std::unique_lock<std::mutex> lock (_mutex);
+	auto &state = slot (report.deviceIndex ());
+	state.paired = true;
+	state.link = (params[0] & LinkNotEstablished ? Link::NotEstablished : Link::Established);
+	state.type = static_cast<IReceiver::DeviceType> (params[0] & DeviceTypeMask);
+	state.wpid = readLE<uint16_t> (params+1);
+	state.last_update = std::chrono::steady_clock::now ();
+	Log::debug ("presence").printf ("Device %d link is %s\n", report.deviceIndex (),
+					state.link == Link::Established ? "established" : "not established");
+	return true;
+}
+
+bool PresenceTracker::disconnectionEvent (const HIDPP::Report &report)
+{
+	// The disconnection type is in the address byte
+	if (report.address () != DeviceUnpaired)
+		return true;
+	std::unique_lock<std::mutex> lock (_mutex);
+	auto &state = slot (report.deviceIndex ());
+	state = DeviceState { false, Link::Unknown, IReceiver::Unknown, 0, std::chrono::steady_clock::now () };
+	Log::debug ("presence").printf ("Device %d was unpaired\n", report.deviceIndex ());
+	return true;
+}
+
+PresenceTracker::DeviceState &PresenceTracker::slot (HIDPP::DeviceIndex index)
+{
+	if (index < HIDPP::WirelessDevice1 || index > HIDPP::WirelessDevice6)
+		throw std::out_of_range ("Not a wireless device index");
+	return _states[index-1];
+}
+
+const PresenceTracker::DeviceState &PresenceTracker::slot (HIDPP::DeviceIndex index) const
+{
+	if (index < HIDPP::WirelessDevice1 || index > HIDPP::WirelessDevice6)
+		throw std::out_of_range ("Not a wireless device index");
+	return _states[index-1];
+}
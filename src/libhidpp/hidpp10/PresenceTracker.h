@@ -0,0 +1,126 @@
+/*
+ * Copyright 2026 Clément Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef LIBHIDPP_HIDPP10_PRESENCE_TRACKER_H
+#define LIBHIDPP_HIDPP10_PRESENCE_TRACKER_H
+
+#include <hidpp/Dispatcher.h>
+#include <hidpp10/IReceiver.h>
+
+#include <array>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+namespace HIDPP10
+{
+
+class Device;
+
+/**
+ * Keep track of the devices connected to a receiver.
+ *
+ * The table is initialized from the receiver pairing information and
+ * then updated from the device connection and disconnection
+ * notifications, so the presence of a wireless device can be known
+ * without pinging it.
+ *
+ * Notifications are only processed while the dispatcher reads reports:
+ * use a DispatcherThread for a live table.
+ */
+class PresenceTracker
+{
+public:
+	enum class Link {
+		Unknown,	///< Paired but no connection notification was received yet.
+		Established,
+		NotEstablished,
+	};
+
+	struct DeviceState
+	{
+		bool paired;
+		Link link;
+		IReceiver::DeviceType type;
+		uint16_t wpid;
+		std::chrono::steady_clock::time_point last_update;
+	};
+
+	/**
+	 * Register the notification handlers on the receiver dispatcher.
+	 *
+	 * \p receiver must be the receiver itself (HIDPP::DefaultDevice).
+	 *
+	 * \see refresh
+	 */
+	PresenceTracker (Device *receiver);
+	~PresenceTracker ();
+
+	PresenceTracker (const PresenceTracker &) = delete;
+	PresenceTracker &operator= (const PresenceTracker &) = delete;
+
+	/**
+	 * Read the pairing information of every slot, enable wireless
+	 * notifications and ask the receiver to notify the current link
+	 * state of each paired device.
+	 */
+	void refresh ();
+
+	/**
+	 * Get the last known state of the device at \p index.
+	 */
+	DeviceState state (HIDPP::DeviceIndex index) const;
+
+	/**
+	 * \returns true if the link with the device is known to be established.
+	 */
+	bool isOnline (HIDPP::DeviceIndex index) const;
+	/**
+	 * \returns true if the device is unpaired or its link is known to be down.
+	 */
+	bool isOffline (HIDPP::DeviceIndex index) const;
+
+	/**
+	 * Indexes of every device currently known to be online.
+	 */
+	std::vector<HIDPP::DeviceIndex> onlineDevices () const;
+
+	/**
+	 * Wait until the device at \p index is connected.
+	 *
+	 * \returns false if the device did not connect in \p timeout milliseconds.
+	 */
+	bool waitForConnection (HIDPP::DeviceIndex index, int timeout);
+
+private:
+	static constexpr unsigned int SlotCount = 6;
+
+	bool connectionEvent (const HIDPP::Report &report);
+	bool disconnectionEvent (const HIDPP::Report &report);
+	DeviceState &slot (HIDPP::DeviceIndex index);
+	const DeviceState &slot (HIDPP::DeviceIndex index) const;
+
+	Device *_receiver;
+	std::vector<HIDPP::Dispatcher::listener_iterator> _listeners;
+	mutable std::mutex _mutex;
+	std::array<DeviceState, SlotCount> _states;
+};
+
+}
+
+#endif
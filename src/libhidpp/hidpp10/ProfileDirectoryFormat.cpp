@@ -24,15 +24,19 @@ using namespace HIDPP;
 using namespace HIDPP10;
 
 ProfileDirectoryFormat::ProfileDirectoryFormat (unsigned int led_count):
-	_led_count (led_count)
+	_led_count (led_count),
+	_settings {
+		{ "leds", SettingDesc (LEDVector (led_count, false)) },
+	}
 {
-	if (led_count > 0)
-		_settings.emplace ("leds", SettingDesc (LEDVector (led_count, false)));
 }
 
-const std::map<std::string, HIDPP::SettingDesc> &ProfileDirectoryFormat::settings () const
+SettingSchema ProfileDirectoryFormat::settings () const
 {
-	return _settings;
+	SettingSchema schema (_settings);
+	if (_led_count == 0)
+		return schema.without (EntrySetting::LEDs);
+	return schema;
 }
 
 ProfileDirectory ProfileDirectoryFormat::read (std::vector<uint8_t>::const_iterator begin) const
@@ -49,7 +53,7 @@ ProfileDirectory ProfileDirectoryFormat::read (std::vector<uint8_t>::const_itera
 			LEDVector leds;
 			for (unsigned int i = 0; i < _led_count; ++i)
 				leds.push_back (bits & 1<<i);
-			dir.entries.back ().settings.emplace ("leds", leds);
+			dir.entries.back ().settings.set (EntrySetting::LEDs, leds);
 		}
 		begin += 3;
 	}
@@ -59,10 +63,10 @@ ProfileDirectory ProfileDirectoryFormat::read (std::vector<uint8_t>::const_itera
 void ProfileDirectoryFormat::write (const ProfileDirectory &dir, std::vector<uint8_t>::iterator begin) const
 {
 	for (const auto &entry: dir.entries) {
-		SettingLookup settings (entry.settings, _settings);
+		SettingLookup settings (entry.settings, this->settings ());
 		begin[0] = entry.profile_address.page;
 		begin[1] = entry.profile_address.offset;
-		LEDVector leds = settings.get<LEDVector> ("leds");
+		LEDVector leds = settings.get<LEDVector> (EntrySetting::LEDs);
 		begin[2] = 0;
 		for (unsigned int i = 0; i < _led_count && i < leds.size (); ++i)
 			if (leds[i])
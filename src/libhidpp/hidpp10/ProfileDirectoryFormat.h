@@ -33,14 +33,23 @@ class ProfileDirectoryFormat: public HIDPP::AbstractProfileDirectoryFormat
 public:
 	ProfileDirectoryFormat (unsigned int led_count);
 
-	virtual const std::map<std::string, HIDPP::SettingDesc> &settings () const;
+	struct EntrySetting
+	{
+		enum: std::size_t
+		{
+			LEDs,
+			Count
+		};
+	};
+
+	virtual HIDPP::SettingSchema settings () const;
 
 	virtual HIDPP::ProfileDirectory read (std::vector<uint8_t>::const_iterator begin) const;
 	virtual void write (const HIDPP::ProfileDirectory &profile_directory, std::vector<uint8_t>::iterator begin) const;
 
 private:
 	unsigned int _led_count;
-	std::map<std::string, HIDPP::SettingDesc> _settings;
+	HIDPP::SettingSchema::Entry _settings[EntrySetting::Count];
 };
 
 std::unique_ptr<HIDPP::AbstractProfileDirectoryFormat> getProfileDirectoryFormat (Device *device);
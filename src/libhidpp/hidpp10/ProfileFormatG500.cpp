@@ -22,6 +22,8 @@
 #include <hidpp/SettingLookup.h>
 #include <hidpp/Field.h>
 
+#include <stdexcept>
+
 using namespace HIDPP;
 using namespace HIDPP10;
 
@@ -47,7 +49,7 @@ static constexpr auto LEDs =	Field<uint16_t, LittleEndian> (4);
 }
 }
 
-const std::map<std::string, SettingDesc> ProfileFormatG500::GeneralSettings = {
+const SettingSchema::Entry ProfileFormatG500::GeneralSettings[] = {
 	{ "color", SettingDesc (Color { 255, 0, 0 }) },
 	{ "angle", SettingDesc (0x00, 0xff, 0x80) },
 	{ "angle_snapping", SettingDesc (false) },
@@ -84,12 +86,12 @@ ProfileFormatG500::ProfileFormatG500 (const Sensor &sensor):
 {
 }
 
-const std::map<std::string, SettingDesc> &ProfileFormatG500::generalSettings () const
+SettingSchema ProfileFormatG500::generalSettings () const
 {
 	return GeneralSettings;
 }
 
-const std::map<std::string, SettingDesc> &ProfileFormatG500::modeSettings () const
+SettingSchema ProfileFormatG500::modeSettings () const
 {
 	return _mode_settings;
 }
@@ -103,8 +105,8 @@ Profile ProfileFormatG500::read (std::vector<uint8_t>::const_iterator begin) con
 {
 	using namespace Fields;
 	Profile profile;
-	profile.settings.emplace ("color", ProfileColor.read (begin));
-	profile.settings.emplace ("angle", static_cast<int> (Angle.read (begin)));
+	profile.settings.set (GeneralSetting::Color, ProfileColor.read (begin));
+	profile.settings.set (GeneralSetting::Angle, static_cast<int> (Angle.read (begin)));
 	for (unsigned int i = 0; i < MaxModeCount; ++i) {
 		auto mode = Modes.begin (begin, i);
 		uint16_t dpi_x = Mode::DPIX.read (mode);
@@ -119,17 +121,17 @@ Profile ProfileFormatG500::read (std::vector<uint8_t>::const_iterator begin) con
 				break;
 			leds.push_back (led == 0x02);
 		}
-		profile.modes.push_back ({
-			{ "dpi_x", static_cast<int> (_sensor.toDPI (dpi_x)) },
-			{ "dpi_y", static_cast<int> (_sensor.toDPI (dpi_y)) },
-			{ "leds", leds },
-		});
+		profile.modes.emplace_back (ModeSetting::Count);
+		auto &mode_settings = profile.modes.back ();
+		mode_settings.set (ModeSetting::DPIX, static_cast<int> (_sensor.toDPI (dpi_x)));
+		mode_settings.set (ModeSetting::DPIY, static_cast<int> (_sensor.toDPI (dpi_y)));
+		mode_settings.set (ModeSetting::LEDs, leds);
 	}
-	profile.settings.emplace ("angle_snapping", AngleSnapping.read (begin) == 0x02);
-	profile.settings.emplace ("default_dpi", static_cast<int> (DefaultDPI.read (begin)));
-	profile.settings.emplace ("lift_threshold", static_cast<int> (LiftThreshold.read (begin))-16);
-	profile.settings.emplace ("unknown", static_cast<int> (Unknown.read (begin)));
-	profile.settings.emplace ("report_rate", static_cast<int> (ReportRate.read (begin)));
+	profile.settings.set (GeneralSetting::AngleSnapping, AngleSnapping.read (begin) == 0x02);
+	profile.settings.set (GeneralSetting::DefaultDPI, static_cast<int> (DefaultDPI.read (begin)));
+	profile.settings.set (GeneralSetting::LiftThreshold, static_cast<int> (LiftThreshold.read (begin))-16);
+	profile.settings.set (GeneralSetting::Unknown, static_cast<int> (Unknown.read (begin)));
+	profile.settings.set (GeneralSetting::ReportRate, static_cast<int> (ReportRate.read (begin)));
 	for (unsigned int i = 0; i < MaxButtonCount; ++i) {
 		profile.buttons.push_back (parseButton (Buttons.begin (begin, i)));
 	}
@@ -140,8 +142,8 @@ void ProfileFormatG500::write (const Profile &profile, std::vector<uint8_t>::ite
 {
 	using namespace Fields;
 	SettingLookup general (profile.settings, GeneralSettings);
-	ProfileColor.write (begin, general.get<Color> ("color"));
-	Angle.write (begin, general.get<int> ("angle"));
+	ProfileColor.write (begin, general.get<Color> (GeneralSetting::Color));
+	Angle.write (begin, general.get<int> (GeneralSetting::Angle));
 
 	for (unsigned int i = 0; i < MaxModeCount; ++i) {
 		auto it = Modes.begin (begin, i);
@@ -151,12 +153,12 @@ void ProfileFormatG500::write (const Profile &profile, std::vector<uint8_t>::ite
 		else {
 			SettingLookup mode (profile.modes[i], _mode_settings);
 
-			int dpi_x = mode.get<int> ("dpi_x");
+			int dpi_x = mode.get<int> (ModeSetting::DPIX);
 			Mode::DPIX.write (it, _sensor.fromDPI (dpi_x));
-			int dpi_y = mode.get ("dpi_y", dpi_x);
+			int dpi_y = mode.get (ModeSetting::DPIY, dpi_x);
 			Mode::DPIY.write (it, _sensor.fromDPI (dpi_y));
 
-			LEDVector leds = mode.get<LEDVector> ("leds");
+			LEDVector leds = mode.get<LEDVector> (ModeSetting::LEDs);
 			uint16_t led_flags = 0;
 			for (unsigned int j = 0; j < LEDCount && j < leds.size (); ++j)
 				led_flags |= (leds[j] ? 0x02 : 0x01) << 4*j;
@@ -164,17 +166,17 @@ void ProfileFormatG500::write (const Profile &profile, std::vector<uint8_t>::ite
 		}
 	}
 
-	bool angle_snapping = general.get<bool> ("angle_snapping");
-	AngleSnapping.write (begin, angle_snapping ? 0x01 : 0x02);
+	bool angle_snapping = general.get<bool> (GeneralSetting::AngleSnapping);
+	AngleSnapping.write (begin, angle_snapping ? 0x02 : 0x01);
 
-	unsigned int default_dpi = general.get<int> ("default_dpi");
+	unsigned int default_dpi = general.get<int> (GeneralSetting::DefaultDPI);
 	if (default_dpi >= profile.modes.size ())
 		default_dpi = profile.modes.size () - 1;
 	DefaultDPI.write (begin, default_dpi);
 
-	LiftThreshold.write (begin, 16 + general.get<int> ("lift_threshold"));
-	Unknown.write (begin, general.get<int> ("unknown"));
-	ReportRate.write (begin, general.get<int> ("report_rate"));
+	LiftThreshold.write (begin, 16 + general.get<int> (GeneralSetting::LiftThreshold));
+	Unknown.write (begin, general.get<int> (GeneralSetting::Unknown));
+	ReportRate.write (begin, general.get<int> (GeneralSetting::ReportRate));
 
 	for (unsigned int i = 0; i < MaxButtonCount; ++i) {
 		Profile::Button button;
@@ -184,3 +186,130 @@ void ProfileFormatG500::write (const Profile &profile, std::vector<uint8_t>::ite
 	}
 }
 
+ProfileFormatG500::ConstView::ConstView (const ProfileFormatG500 &format, std::vector<uint8_t>::const_iterator begin):
+	_format (format),
+	_begin (begin)
+{
+}
+
+Color ProfileFormatG500::ConstView::color () const
+{
+	return Fields::ProfileColor.read (_begin);
+}
+
+int ProfileFormatG500::ConstView::angle () const
+{
+	return Fields::Angle.read (_begin);
+}
+
+unsigned int ProfileFormatG500::ConstView::modeCount () const
+{
+	unsigned int count = 1;
+	while (count < MaxModeCount &&
+	       Fields::Mode::DPIX.read (Fields::Modes.begin (_begin, count)) != 0)
+		++count;
+	return count;
+}
+
+int ProfileFormatG500::ConstView::dpiX (unsigned int mode) const
+{
+	if (mode >= MaxModeCount)
+		throw std::out_of_range ("mode index");
+	return _format._sensor.toDPI (Fields::Mode::DPIX.read (Fields::Modes.begin (_begin, mode)));
+}
+
+int ProfileFormatG500::ConstView::dpiY (unsigned int mode) const
+{
+	if (mode >= MaxModeCount)
+		throw std::out_of_range ("mode index");
+	return _format._sensor.toDPI (Fields::Mode::DPIY.read (Fields::Modes.begin (_begin, mode)));
+}
+
+bool ProfileFormatG500::ConstView::angleSnapping () const
+{
+	return Fields::AngleSnapping.read (_begin) == 0x02;
+}
+
+int ProfileFormatG500::ConstView::defaultDPI () const
+{
+	return Fields::DefaultDPI.read (_begin);
+}
+
+int ProfileFormatG500::ConstView::liftThreshold () const
+{
+	return static_cast<int> (Fields::LiftThreshold.read (_begin)) - 16;
+}
+
+int ProfileFormatG500::ConstView::reportRate () const
+{
+	return Fields::ReportRate.read (_begin);
+}
+
+Profile::Button ProfileFormatG500::ConstView::button (unsigned int index) const
+{
+	if (index >= MaxButtonCount)
+		throw std::out_of_range ("button index");
+	return parseButton (Fields::Buttons.begin (_begin, index));
+}
+
+ProfileFormatG500::View::View (const ProfileFormatG500 &format, std::vector<uint8_t>::iterator begin):
+	ConstView (format, begin),
+	_wbegin (begin)
+{
+}
+
+void ProfileFormatG500::View::setColor (Color color) const
+{
+	Fields::ProfileColor.write (_wbegin, color);
+}
+
+void ProfileFormatG500::View::setAngle (int angle) const
+{
+	Fields::Angle.write (_wbegin, angle);
+}
+
+void ProfileFormatG500::View::setDPI (unsigned int mode, int dpi_x, int dpi_y) const
+{
+	if (mode >= MaxModeCount)
+		throw std::out_of_range ("mode index");
+	auto it = Fields::Modes.begin (_wbegin, mode);
+	Fields::Mode::DPIX.write (it, _format._sensor.fromDPI (dpi_x));
+	Fields::Mode::DPIY.write (it, _format._sensor.fromDPI (dpi_y));
+}
+
+void ProfileFormatG500::View::setAngleSnapping (bool angle_snapping) const
+{
+	Fields::AngleSnapping.write (_wbegin, angle_snapping ? 0x02 : 0x01);
+}
+
+void ProfileFormatG500::View::setDefaultDPI (int index) const
+{
+	Fields::DefaultDPI.write (_wbegin, index);
+}
+
+void ProfileFormatG500::View::setLiftThreshold (int lift_threshold) const
+{
+	Fields::LiftThreshold.write (_wbegin, 16 + lift_threshold);
+}
+
+void ProfileFormatG500::View::setReportRate (int report_rate) const
+{
+	Fields::ReportRate.write (_wbegin, report_rate);
+}
+
+void ProfileFormatG500::View::setButton (unsigned int index, const Profile::Button &button) const
+{
+	if (index >= MaxButtonCount)
+		throw std::out_of_range ("button index");
+	writeButton (Fields::Buttons.begin (_wbegin, index), button);
+}
+
+ProfileFormatG500::ConstView ProfileFormatG500::view (std::vector<uint8_t>::const_iterator begin) const
+{
+	return ConstView (*this, begin);
+}
+
+ProfileFormatG500::View ProfileFormatG500::view (std::vector<uint8_t>::iterator begin) const
+{
+	return View (*this, begin);
+}
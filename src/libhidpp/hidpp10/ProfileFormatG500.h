@@ -30,24 +30,111 @@ class ProfileFormatG500: public HIDPP::AbstractProfileFormat
 public:
 	ProfileFormatG500 (const Sensor &sensor);
 
-	virtual const std::map<std::string, HIDPP::SettingDesc> &generalSettings () const;
-	virtual const std::map<std::string, HIDPP::SettingDesc> &modeSettings () const;
+	struct GeneralSetting
+	{
+		enum: std::size_t
+		{
+			Color,
+			Angle,
+			AngleSnapping,
+			DefaultDPI,
+			LiftThreshold,
+			Unknown,
+			ReportRate,
+			Count
+		};
+	};
+	struct ModeSetting
+	{
+		enum: std::size_t
+		{
+			DPIX,
+			DPIY,
+			LEDs,
+			Count
+		};
+	};
+
+	virtual HIDPP::SettingSchema generalSettings () const;
+	virtual HIDPP::SettingSchema modeSettings () const;
 	virtual const HIDPP::EnumDesc &specialActions () const;
 
 	virtual HIDPP::Profile read (std::vector<uint8_t>::const_iterator begin) const;
 	virtual void write (const HIDPP::Profile &profile, std::vector<uint8_t>::iterator begin) const;
 
+	/**
+	 * Read-only access to the fields of the profile beginning at \p begin
+	 * without decoding the whole profile.
+	 *
+	 * The view does not copy the profile, the memory must stay valid and
+	 * unmoved while it is used. Resolutions are converted with the sensor.
+	 */
+	class ConstView
+	{
+	public:
+		ConstView (const ProfileFormatG500 &format, std::vector<uint8_t>::const_iterator begin);
+
+		HIDPP::Color color () const;
+		int angle () const;
+		/**
+		 * Number of enabled modes.
+		 */
+		unsigned int modeCount () const;
+		int dpiX (unsigned int mode) const;
+		int dpiY (unsigned int mode) const;
+		bool angleSnapping () const;
+		int defaultDPI () const;
+		int liftThreshold () const;
+		int reportRate () const;
+		HIDPP::Profile::Button button (unsigned int index) const;
+
+	protected:
+		const ProfileFormatG500 &_format;
+		std::vector<uint8_t>::const_iterator _begin;
+	};
+
+	/**
+	 * Same as ConstView but also modifies the fields in place.
+	 *
+	 * Values are not checked against the setting descriptions.
+	 */
+	class View: public ConstView
+	{
+	public:
+		View (const ProfileFormatG500 &format, std::vector<uint8_t>::iterator begin);
+
+		void setColor (HIDPP::Color color) const;
+		void setAngle (int angle) const;
+		/**
+		 * Enabled modes end at the first mode with a zero resolution (see
+		 * modeCount), so a non-zero resolution only enables a disabled mode
+		 * if every mode before it is enabled.
+		 */
+		void setDPI (unsigned int mode, int dpi_x, int dpi_y) const;
+		void setAngleSnapping (bool angle_snapping) const;
+		void setDefaultDPI (int index) const;
+		void setLiftThreshold (int lift_threshold) const;
+		void setReportRate (int report_rate) const;
+		void setButton (unsigned int index, const HIDPP::Profile::Button &button) const;
+
+	private:
+		std::vector<uint8_t>::iterator _wbegin;
+	};
+
+	ConstView view (std::vector<uint8_t>::const_iterator begin) const;
+	View view (std::vector<uint8_t>::iterator begin) const;
+
 private:
 	const Sensor &_sensor;
 	HIDPP::SettingDesc _dpi_setting;
-	std::map<std::string, HIDPP::SettingDesc> _mode_settings;
+	HIDPP::SettingSchema::Entry _mode_settings[ModeSetting::Count];
 
 	static constexpr size_t ProfileSize = 78;
 	static constexpr unsigned int MaxButtonCount = 13;
 	static constexpr unsigned int MaxModeCount = 5;
 	static constexpr unsigned int LEDCount = 4;
 
-	static const std::map<std::string, HIDPP::SettingDesc> GeneralSettings;
+	static const HIDPP::SettingSchema::Entry GeneralSettings[GeneralSetting::Count];
 	static const HIDPP::EnumDesc SpecialActions;
 };
 
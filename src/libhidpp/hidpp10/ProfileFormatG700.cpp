@@ -22,6 +22,8 @@
 #include <hidpp/SettingLookup.h>
 #include <hidpp/Field.h>
 
+#include <stdexcept>
+
 using namespace HIDPP;
 using namespace HIDPP10;
 
@@ -55,7 +57,7 @@ static constexpr auto LEDs =	Field<uint16_t, LittleEndian> (2);
 }
 }
 
-const std::map<std::string, SettingDesc> ProfileFormatG700::GeneralSettings = {
+const SettingSchema::Entry ProfileFormatG700::GeneralSettings[] = {
 	{ "default_dpi", SettingDesc (0, MaxModeCount-1, 0) },
 	{ "angle", SettingDesc (0x00, 0xff, 0x80) },
 	{ "angle_snapping", SettingDesc (false) },
@@ -105,12 +107,12 @@ ProfileFormatG700::ProfileFormatG700 (const Sensor &sensor):
 {
 }
 
-const std::map<std::string, SettingDesc> &ProfileFormatG700::generalSettings () const
+SettingSchema ProfileFormatG700::generalSettings () const
 {
 	return GeneralSettings;
 }
 
-const std::map<std::string, SettingDesc> &ProfileFormatG700::modeSettings () const
+SettingSchema ProfileFormatG700::modeSettings () const
 {
 	return _mode_settings;
 }
@@ -139,28 +141,28 @@ Profile ProfileFormatG700::read (std::vector<uint8_t>::const_iterator begin) con
 				break;
 			leds.push_back (led == 0x02);
 		}
-		profile.modes.push_back ({
-			{ "dpi_x", static_cast<int> (_sensor.toDPI (dpi_x)) },
-			{ "dpi_y", static_cast<int> (_sensor.toDPI (dpi_y)) },
-			{ "leds", leds },
-		});
+		profile.modes.emplace_back (ModeSetting::Count);
+		auto &mode_settings = profile.modes.back ();
+		mode_settings.set (ModeSetting::DPIX, static_cast<int> (_sensor.toDPI (dpi_x)));
+		mode_settings.set (ModeSetting::DPIY, static_cast<int> (_sensor.toDPI (dpi_y)));
+		mode_settings.set (ModeSetting::LEDs, leds);
 	}
 
-	profile.settings.emplace ("default_dpi", static_cast<int> (DefaultDPI.read (begin)));
-	profile.settings.emplace ("angle", static_cast<int> (Angle.read (begin)));
-	profile.settings.emplace ("angle_snapping", AngleSnapping.read (begin) == 0x02);
-	profile.settings.emplace ("unknown0", static_cast<int> (Unknown0.read (begin)));
-	profile.settings.emplace ("report_rate", static_cast<int> (ReportRate.read (begin)));
-	profile.settings.emplace ("unknown1", static_cast<int> (Unknown1.read (begin)));
-	profile.settings.emplace ("unknown2", static_cast<int> (Unknown2.read (begin)));
-	profile.settings.emplace ("unknown3", static_cast<int> (Unknown3.read (begin)));
-	profile.settings.emplace ("unknown4", static_cast<int> (Unknown4.read (begin)));
-	profile.settings.emplace ("power_mode", static_cast<int> (PowerMode.read (begin)));
-	profile.settings.emplace ("unknown5", static_cast<int> (Unknown5.read (begin)));
-	profile.settings.emplace ("unknown6", static_cast<int> (Unknown6.read (begin)));
-	profile.settings.emplace ("unknown7", static_cast<int> (Unknown7.read (begin)));
-	profile.settings.emplace ("unknown8", static_cast<int> (Unknown8.read (begin)));
-	profile.settings.emplace ("unknown9", static_cast<int> (Unknown9.read (begin)));
+	profile.settings.set (GeneralSetting::DefaultDPI, static_cast<int> (DefaultDPI.read (begin)));
+	profile.settings.set (GeneralSetting::Angle, static_cast<int> (Angle.read (begin)));
+	profile.settings.set (GeneralSetting::AngleSnapping, AngleSnapping.read (begin) == 0x02);
+	profile.settings.set (GeneralSetting::Unknown0, static_cast<int> (Unknown0.read (begin)));
+	profile.settings.set (GeneralSetting::ReportRate, static_cast<int> (ReportRate.read (begin)));
+	profile.settings.set (GeneralSetting::Unknown1, static_cast<int> (Unknown1.read (begin)));
+	profile.settings.set (GeneralSetting::Unknown2, static_cast<int> (Unknown2.read (begin)));
+	profile.settings.set (GeneralSetting::Unknown3, static_cast<int> (Unknown3.read (begin)));
+	profile.settings.set (GeneralSetting::Unknown4, static_cast<int> (Unknown4.read (begin)));
+	profile.settings.set (GeneralSetting::PowerMode, static_cast<int> (PowerMode.read (begin)));
+	profile.settings.set (GeneralSetting::Unknown5, static_cast<int> (Unknown5.read (begin)));
+	profile.settings.set (GeneralSetting::Unknown6, static_cast<int> (Unknown6.read (begin)));
+	profile.settings.set (GeneralSetting::Unknown7, static_cast<int> (Unknown7.read (begin)));
+	profile.settings.set (GeneralSetting::Unknown8, static_cast<int> (Unknown8.read (begin)));
+	profile.settings.set (GeneralSetting::Unknown9, static_cast<int> (Unknown9.read (begin)));
 
 	for (unsigned int i = 0; i < MaxButtonCount; ++i) {
 		profile.buttons.push_back (parseButton (Buttons.begin (begin, i)));
@@ -182,12 +184,12 @@ void ProfileFormatG700::write (const Profile &profile, std::vector<uint8_t>::ite
 		else {
 			SettingLookup mode (profile.modes[i], _mode_settings);
 
-			int dpi_x = mode.get<int> ("dpi_x");
+			int dpi_x = mode.get<int> (ModeSetting::DPIX);
 			Mode::DPIX.write (it, _sensor.fromDPI (dpi_x));
-			int dpi_y = mode.get ("dpi_y", dpi_x);
+			int dpi_y = mode.get (ModeSetting::DPIY, dpi_x);
 			Mode::DPIY.write (it, _sensor.fromDPI (dpi_y));
 
-			LEDVector leds = mode.get<LEDVector> ("leds");
+			LEDVector leds = mode.get<LEDVector> (ModeSetting::LEDs);
 			uint16_t led_flags = 0;
 			for (unsigned int j = 0; j < LEDCount && j < leds.size (); ++j)
 				led_flags |= (leds[j] ? 0x02 : 0x01) << 4*j;
@@ -195,28 +197,28 @@ void ProfileFormatG700::write (const Profile &profile, std::vector<uint8_t>::ite
 		}
 	}
 
-	unsigned int default_dpi = general.get<int> ("default_dpi");
+	unsigned int default_dpi = general.get<int> (GeneralSetting::DefaultDPI);
 	if (default_dpi >= profile.modes.size ())
 		default_dpi = profile.modes.size () - 1;
 	DefaultDPI.write (begin, default_dpi);
 
-	Angle.write (begin, general.get<int> ("angle"));
+	Angle.write (begin, general.get<int> (GeneralSetting::Angle));
 
-	bool angle_snapping = general.get<bool> ("angle_snapping");
-	AngleSnapping.write (begin, angle_snapping ? 0x01 : 0x02);
+	bool angle_snapping = general.get<bool> (GeneralSetting::AngleSnapping);
+	AngleSnapping.write (begin, angle_snapping ? 0x02 : 0x01);
 
-	Unknown0.write (begin, general.get<int> ("unknown0"));
-	ReportRate.write (begin, general.get<int> ("report_rate"));
-	Unknown1.write (begin, general.get<int> ("unknown1"));
-	Unknown2.write (begin, general.get<int> ("unknown2"));
-	Unknown3.write (begin, general.get<int> ("unknown3"));
-	Unknown4.write (begin, general.get<int> ("unknown4"));
-	PowerMode.write (begin, general.get<int> ("power_mode"));
-	Unknown5.write (begin, general.get<int> ("unknown5"));
-	Unknown6.write (begin, general.get<int> ("unknown6"));
-	Unknown7.write (begin, general.get<int> ("unknown7"));
-	Unknown8.write (begin, general.get<int> ("unknown8"));
-	Unknown9.write (begin, general.get<int> ("unknown9"));
+	Unknown0.write (begin, general.get<int> (GeneralSetting::Unknown0));
+	ReportRate.write (begin, general.get<int> (GeneralSetting::ReportRate));
+	Unknown1.write (begin, general.get<int> (GeneralSetting::Unknown1));
+	Unknown2.write (begin, general.get<int> (GeneralSetting::Unknown2));
+	Unknown3.write (begin, general.get<int> (GeneralSetting::Unknown3));
+	Unknown4.write (begin, general.get<int> (GeneralSetting::Unknown4));
+	PowerMode.write (begin, general.get<int> (GeneralSetting::PowerMode));
+	Unknown5.write (begin, general.get<int> (GeneralSetting::Unknown5));
+	Unknown6.write (begin, general.get<int> (GeneralSetting::Unknown6));
+	Unknown7.write (begin, general.get<int> (GeneralSetting::Unknown7));
+	Unknown8.write (begin, general.get<int> (GeneralSetting::Unknown8));
+	Unknown9.write (begin, general.get<int> (GeneralSetting::Unknown9));
 
 	for (unsigned int i = 0; i < MaxButtonCount; ++i) {
 		Profile::Button button;
@@ -226,3 +228,120 @@ void ProfileFormatG700::write (const Profile &profile, std::vector<uint8_t>::ite
 	}
 }
 
+ProfileFormatG700::ConstView::ConstView (const ProfileFormatG700 &format, std::vector<uint8_t>::const_iterator begin):
+	_format (format),
+	_begin (begin)
+{
+}
+
+unsigned int ProfileFormatG700::ConstView::modeCount () const
+{
+	unsigned int count = 1;
+	while (count < MaxModeCount &&
+	       Fields::Mode::DPIX.read (Fields::Modes.begin (_begin, count)) != 0)
+		++count;
+	return count;
+}
+
+int ProfileFormatG700::ConstView::dpiX (unsigned int mode) const
+{
+	if (mode >= MaxModeCount)
+		throw std::out_of_range ("mode index");
+	return _format._sensor.toDPI (Fields::Mode::DPIX.read (Fields::Modes.begin (_begin, mode)));
+}
+
+int ProfileFormatG700::ConstView::dpiY (unsigned int mode) const
+{
+	if (mode >= MaxModeCount)
+		throw std::out_of_range ("mode index");
+	return _format._sensor.toDPI (Fields::Mode::DPIY.read (Fields::Modes.begin (_begin, mode)));
+}
+
+int ProfileFormatG700::ConstView::defaultDPI () const
+{
+	return Fields::DefaultDPI.read (_begin);
+}
+
+int ProfileFormatG700::ConstView::angle () const
+{
+	return Fields::Angle.read (_begin);
+}
+
+bool ProfileFormatG700::ConstView::angleSnapping () const
+{
+	return Fields::AngleSnapping.read (_begin) == 0x02;
+}
+
+int ProfileFormatG700::ConstView::reportRate () const
+{
+	return Fields::ReportRate.read (_begin);
+}
+
+int ProfileFormatG700::ConstView::powerMode () const
+{
+	return Fields::PowerMode.read (_begin);
+}
+
+Profile::Button ProfileFormatG700::ConstView::button (unsigned int index) const
+{
+	if (index >= MaxButtonCount)
+		throw std::out_of_range ("button index");
+	return parseButton (Fields::Buttons.begin (_begin, index));
+}
+
+ProfileFormatG700::View::View (const ProfileFormatG700 &format, std::vector<uint8_t>::iterator begin):
+	ConstView (format, begin),
+	_wbegin (begin)
+{
+}
+
+void ProfileFormatG700::View::setDPI (unsigned int mode, int dpi_x, int dpi_y) const
+{
+	if (mode >= MaxModeCount)
+		throw std::out_of_range ("mode index");
+	auto it = Fields::Modes.begin (_wbegin, mode);
+	Fields::Mode::DPIX.write (it, _format._sensor.fromDPI (dpi_x));
+	Fields::Mode::DPIY.write (it, _format._sensor.fromDPI (dpi_y));
+}
+
+void ProfileFormatG700::View::setDefaultDPI (int index) const
+{
+	Fields::DefaultDPI.write (_wbegin, index);
+}
+
+void ProfileFormatG700::View::setAngle (int angle) const
+{
+	Fields::Angle.write (_wbegin, angle);
+}
+
+void ProfileFormatG700::View::setAngleSnapping (bool angle_snapping) const
+{
+	Fields::AngleSnapping.write (_wbegin, angle_snapping ? 0x02 : 0x01);
+}
+
+void ProfileFormatG700::View::setReportRate (int report_rate) const
+{
+	Fields::ReportRate.write (_wbegin, report_rate);
+}
+
+void ProfileFormatG700::View::setPowerMode (int power_mode) const
+{
+	Fields::PowerMode.write (_wbegin, power_mode);
+}
+
+void ProfileFormatG700::View::setButton (unsigned int index, const Profile::Button &button) const
+{
+	if (index >= MaxButtonCount)
+		throw std::out_of_range ("button index");
+	writeButton (Fields::Buttons.begin (_wbegin, index), button);
+}
+
+ProfileFormatG700::ConstView ProfileFormatG700::view (std::vector<uint8_t>::const_iterator begin) const
+{
+	return ConstView (*this, begin);
+}
+
+ProfileFormatG700::View ProfileFormatG700::view (std::vector<uint8_t>::iterator begin) const
+{
+	return View (*this, begin);
+}
@@ -30,24 +30,117 @@ class ProfileFormatG700: public HIDPP::AbstractProfileFormat
 public:
 	ProfileFormatG700 (const Sensor &sensor);
 
-	virtual const std::map<std::string, HIDPP::SettingDesc> &generalSettings () const;
-	virtual const std::map<std::string, HIDPP::SettingDesc> &modeSettings () const;
+	struct GeneralSetting
+	{
+		enum: std::size_t
+		{
+			DefaultDPI,
+			Angle,
+			AngleSnapping,
+			Unknown0,
+			ReportRate,
+			Unknown1,
+			Unknown2,
+			Unknown3,
+			Unknown4,
+			PowerMode,
+			Unknown5,
+			Unknown6,
+			Unknown7,
+			Unknown8,
+			Unknown9,
+			Count
+		};
+	};
+	struct ModeSetting
+	{
+		enum: std::size_t
+		{
+			DPIX,
+			DPIY,
+			LEDs,
+			Count
+		};
+	};
+
+	virtual HIDPP::SettingSchema generalSettings () const;
+	virtual HIDPP::SettingSchema modeSettings () const;
 	virtual const HIDPP::EnumDesc &specialActions () const;
 
 	virtual HIDPP::Profile read (std::vector<uint8_t>::const_iterator begin) const;
 	virtual void write (const HIDPP::Profile &profile, std::vector<uint8_t>::iterator begin) const;
 
+	/**
+	 * Read-only access to the fields of the profile beginning at \p begin
+	 * without decoding the whole profile.
+	 *
+	 * The view does not copy the profile, the memory must stay valid and
+	 * unmoved while it is used. Resolutions are converted with the sensor.
+	 */
+	class ConstView
+	{
+	public:
+		ConstView (const ProfileFormatG700 &format, std::vector<uint8_t>::const_iterator begin);
+
+		/**
+		 * Number of enabled modes.
+		 */
+		unsigned int modeCount () const;
+		int dpiX (unsigned int mode) const;
+		int dpiY (unsigned int mode) const;
+		int defaultDPI () const;
+		int angle () const;
+		bool angleSnapping () const;
+		int reportRate () const;
+		int powerMode () const;
+		HIDPP::Profile::Button button (unsigned int index) const;
+
+	protected:
+		const ProfileFormatG700 &_format;
+		std::vector<uint8_t>::const_iterator _begin;
+	};
+
+	/**
+	 * Same as ConstView but also modifies the fields in place.
+	 *
+	 * Values are not checked against the setting descriptions.
+	 */
+	class View: public ConstView
+	{
+	public:
+		View (const ProfileFormatG700 &format, std::vector<uint8_t>::iterator begin);
+
+		/**
+		 * Enabled modes end at the first mode with a zero resolution (see
+		 * modeCount), so a non-zero resolution only enables a disabled mode
+		 * if every mode before it is enabled.
+		 */
+		void setDPI (unsigned int mode, int dpi_x, int dpi_y) const;
+		void setDefaultDPI (int index) const;
+		void setAngle (int angle) const;
+		void setAngleSnapping (bool angle_snapping) const;
+		void setReportRate (int report_rate) const;
+		void setPowerMode (int power_mode) const;
+		void setButton (unsigned int index, const HIDPP::Profile::Button &button) const;
+
+	private:
+		std::vector<uint8_t>::iterator _wbegin;
+	};
+
+	ConstView view (std::vector<uint8_t>::const_iterator begin) const;
+	View view (std::vector<uint8_t>::iterator begin) const;
+
 private:
 	const Sensor &_sensor;
 	HIDPP::SettingDesc _dpi_setting;
-	std::map<std::string, HIDPP::SettingDesc> _mode_settings;
+	HIDPP::SettingSchema::Entry _mode_settings[ModeSetting::Count];
 
 	static constexpr size_t ProfileSize = 74;
 	static constexpr unsigned int MaxButtonCount = 13;
 	static constexpr unsigned int MaxModeCount = 5;
 	static constexpr unsigned int LEDCount = 4;
 
-	static const std::map<std::string, HIDPP::SettingDesc> GeneralSettings;
+	static const HIDPP::SettingSchema::Entry GeneralSettings[GeneralSetting::Count];
 	static const HIDPP::EnumDesc SpecialActions;
 };
 
@@ -22,6 +22,8 @@
 #include <hidpp/SettingLookup.h>
 #include <hidpp/Field.h>
 
+#include <stdexcept>
+
 using namespace HIDPP;
 using namespace HIDPP10;
 
@@ -48,7 +50,7 @@ static constexpr auto LEDs =	Field<uint16_t, LittleEndian> (1);
 }
 }
 
-const std::map<std::string, SettingDesc> ProfileFormatG9::GeneralSettings = {
+const SettingSchema::Entry ProfileFormatG9::GeneralSettings[] = {
 	{ "color", SettingDesc (Color { 255, 0, 0 }) },
 	{ "unknown0", SettingDesc (0x00, 0xff, 0x10) },
 	{ "default_dpi", SettingDesc (0, MaxModeCount-1, 0) },
@@ -89,12 +91,12 @@ ProfileFormatG9::ProfileFormatG9 (const Sensor &sensor):
 {
 }
 
-const std::map<std::string, SettingDesc> &ProfileFormatG9::generalSettings () const
+SettingSchema ProfileFormatG9::generalSettings () const
 {
 	return GeneralSettings;
 }
 
-const std::map<std::string, SettingDesc> &ProfileFormatG9::modeSettings () const
+SettingSchema ProfileFormatG9::modeSettings () const
 {
 	return _mode_settings;
 }
@@ -109,8 +111,8 @@ Profile ProfileFormatG9::read (std::vector<uint8_t>::const_iterator begin) const
 	using namespace Fields;
 	Profile profile;
 
-	profile.settings.emplace ("color", ProfileColor.read (begin));
-	profile.settings.emplace ("unknown0", static_cast<int> (Unknown0.read (begin)));
+	profile.settings.set (GeneralSetting::Color, ProfileColor.read (begin));
+	profile.settings.set (GeneralSetting::Unknown0, static_cast<int> (Unknown0.read (begin)));
 
 	for (unsigned int i = 0; i < MaxModeCount; ++i) {
 		auto mode = Modes.begin (begin, i);
@@ -125,28 +127,28 @@ Profile ProfileFormatG9::read (std::vector<uint8_t>::const_iterator begin) const
 				break;
 			leds.push_back (led == 0x02);
 		}
-		profile.modes.push_back ({
-			{ "dpi", static_cast<int> (_sensor.toDPI (dpi)) },
-			{ "leds", leds },
-		});
+		profile.modes.emplace_back (ModeSetting::Count);
+		auto &mode_settings = profile.modes.back ();
+		mode_settings.set (ModeSetting::DPI, static_cast<int> (_sensor.toDPI (dpi)));
+		mode_settings.set (ModeSetting::LEDs, leds);
 	}
 
 	uint8_t default_dpi = DefaultDPI.read (begin);
 	bool bit7 = default_dpi & 0x80;
-	profile.settings.emplace ("default_dpi", static_cast<int> (default_dpi & ~0x80));
-	profile.settings.emplace ("default_dpi_bit7", bit7);
+	profile.settings.set (GeneralSetting::DefaultDPI, static_cast<int> (default_dpi & ~0x80));
+	profile.settings.set (GeneralSetting::DefaultDPIBit7, bit7);
 
-	profile.settings.emplace ("unknown1", static_cast<int> (Unknown1.read (begin)));
-	profile.settings.emplace ("unknown2", static_cast<int> (Unknown2.read (begin)));
-	profile.settings.emplace ("report_rate", static_cast<int> (ReportRate.read (begin)));
+	profile.settings.set (GeneralSetting::Unknown1, static_cast<int> (Unknown1.read (begin)));
+	profile.settings.set (GeneralSetting::Unknown2, static_cast<int> (Unknown2.read (begin)));
+	profile.settings.set (GeneralSetting::ReportRate, static_cast<int> (ReportRate.read (begin)));
 
 	for (unsigned int i = 0; i < MaxButtonCount; ++i) {
 		profile.buttons.push_back (parseButton (Buttons.begin (begin, i)));
 	}
 
-	profile.settings.emplace ("unknown3", static_cast<int> (Unknown3.read (begin)));
-	profile.settings.emplace ("unknown4", static_cast<int> (Unknown4.read (begin)));
-	profile.settings.emplace ("unknown5", static_cast<int> (Unknown5.read (begin)));
+	profile.settings.set (GeneralSetting::Unknown3, static_cast<int> (Unknown3.read (begin)));
+	profile.settings.set (GeneralSetting::Unknown4, static_cast<int> (Unknown4.read (begin)));
+	profile.settings.set (GeneralSetting::Unknown5, static_cast<int> (Unknown5.read (begin)));
 
 	return profile;
 }
@@ -156,8 +158,8 @@ void ProfileFormatG9::write (const Profile &profile, std::vector<uint8_t>::itera
 	using namespace Fields;
 	SettingLookup general (profile.settings, GeneralSettings);
 
-	ProfileColor.write (begin, general.get<Color> ("color"));
-	Unknown0.write (begin, general.get<int> ("unknown0"));
+	ProfileColor.write (begin, general.get<Color> (GeneralSetting::Color));
+	Unknown0.write (begin, general.get<int> (GeneralSetting::Unknown0));
 
 	for (unsigned int i = 0; i < MaxModeCount; ++i) {
 		auto it = Modes.begin (begin, i);
@@ -167,10 +169,10 @@ void ProfileFormatG9::write (const Profile &profile, std::vector<uint8_t>::itera
 		else {
 			SettingLookup mode (profile.modes[i], _mode_settings);
 
-			int dpi = mode.get<int> ("dpi");
+			int dpi = mode.get<int> (ModeSetting::DPI);
 			Mode::DPI.write (it, _sensor.fromDPI (dpi));
 
-			LEDVector leds = mode.get<LEDVector> ("leds");
+			LEDVector leds = mode.get<LEDVector> (ModeSetting::LEDs);
 			uint16_t led_flags = 0;
 			for (unsigned int j = 0; j < LEDCount && j < leds.size (); ++j)
 				led_flags |= (leds[j] ? 0x02 : 0x01) << 4*j;
@@ -178,16 +180,16 @@ void ProfileFormatG9::write (const Profile &profile, std::vector<uint8_t>::itera
 		}
 	}
 
-	unsigned int default_dpi = general.get<int> ("default_dpi");
+	unsigned int default_dpi = general.get<int> (GeneralSetting::DefaultDPI);
 	if (default_dpi >= profile.modes.size ())
 		default_dpi = profile.modes.size () - 1;
-	if (general.get<bool> ("default_dpi_bit7"))
+	if (general.get<bool> (GeneralSetting::DefaultDPIBit7))
 		default_dpi |= 0x80;
 	DefaultDPI.write (begin, default_dpi);
 
-	Unknown1.write (begin, general.get<int> ("unknown1"));
-	Unknown2.write (begin, general.get<int> ("unknown2"));
-	ReportRate.write (begin, general.get<int> ("report_rate"));
+	Unknown1.write (begin, general.get<int> (GeneralSetting::Unknown1));
+	Unknown2.write (begin, general.get<int> (GeneralSetting::Unknown2));
+	ReportRate.write (begin, general.get<int> (GeneralSetting::ReportRate));
 
 	for (unsigned int i = 0; i < MaxButtonCount; ++i) {
 		Profile::Button button;
@@ -196,8 +198,98 @@ void ProfileFormatG9::write (const Profile &profile, std::vector<uint8_t>::itera
 		writeButton (Buttons.begin (begin, i), button);
 	}
 
-	Unknown3.write (begin, general.get<int> ("unknown3"));
-	Unknown4.write (begin, general.get<int> ("unknown4"));
-	Unknown5.write (begin, general.get<int> ("unknown5"));
+	Unknown3.write (begin, general.get<int> (GeneralSetting::Unknown3));
+	Unknown4.write (begin, general.get<int> (GeneralSetting::Unknown4));
+	Unknown5.write (begin, general.get<int> (GeneralSetting::Unknown5));
+}
+
+ProfileFormatG9::ConstView::ConstView (const ProfileFormatG9 &format, std::vector<uint8_t>::const_iterator begin):
+	_format (format),
+	_begin (begin)
+{
+}
+
+Color ProfileFormatG9::ConstView::color () const
+{
+	return Fields::ProfileColor.read (_begin);
+}
+
+unsigned int ProfileFormatG9::ConstView::modeCount () const
+{
+	unsigned int count = 1;
+	while (count < MaxModeCount &&
+	       Fields::Mode::DPI.read (Fields::Modes.begin (_begin, count)) != 0)
+		++count;
+	return count;
 }
 
+int ProfileFormatG9::ConstView::dpi (unsigned int mode) const
+{
+	if (mode >= MaxModeCount)
+		throw std::out_of_range ("mode index");
+	return _format._sensor.toDPI (Fields::Mode::DPI.read (Fields::Modes.begin (_begin, mode)));
+}
+
+int ProfileFormatG9::ConstView::defaultDPI () const
+{
+	return Fields::DefaultDPI.read (_begin) & ~0x80;
+}
+
+int ProfileFormatG9::ConstView::reportRate () const
+{
+	return Fields::ReportRate.read (_begin);
+}
+
+Profile::Button ProfileFormatG9::ConstView::button (unsigned int index) const
+{
+	if (index >= MaxButtonCount)
+		throw std::out_of_range ("button index");
+	return parseButton (Fields::Buttons.begin (_begin, index));
+}
+
+ProfileFormatG9::View::View (const ProfileFormatG9 &format, std::vector<uint8_t>::iterator begin):
+	ConstView (format, begin),
+	_wbegin (begin)
+{
+}
+
+void ProfileFormatG9::View::setColor (Color color) const
+{
+	Fields::ProfileColor.write (_wbegin, color);
+}
+
+void ProfileFormatG9::View::setDPI (unsigned int mode, int dpi) const
+{
+	if (mode >= MaxModeCount)
+		throw std::out_of_range ("mode index");
+	auto it = Fields::Modes.begin (_wbegin, mode);
+	Fields::Mode::DPI.write (it, _format._sensor.fromDPI (dpi));
+}
+
+void ProfileFormatG9::View::setDefaultDPI (int index) const
+{
+	uint8_t bit7 = Fields::DefaultDPI.read (_wbegin) & 0x80;
+	Fields::DefaultDPI.write (_wbegin, bit7 | index);
+}
+
+void ProfileFormatG9::View::setReportRate (int report_rate) const
+{
+	Fields::ReportRate.write (_wbegin, report_rate);
+}
+
+void ProfileFormatG9::View::setButton (unsigned int index, const Profile::Button &button) const
+{
+	if (index >= MaxButtonCount)
+		throw std::out_of_range ("button index");
+	writeButton (Fields::Buttons.begin (_wbegin, index), button);
+}
+
+ProfileFormatG9::ConstView ProfileFormatG9::view (std::vector<uint8_t>::const_iterator begin) const
+{
+	return ConstView (*this, begin);
+}
+
+ProfileFormatG9::View ProfileFormatG9::view (std::vector<uint8_t>::iterator begin) const
+{
+	return View (*this, begin);
+}
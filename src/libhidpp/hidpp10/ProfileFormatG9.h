@@ -30,24 +30,112 @@ class ProfileFormatG9: public HIDPP::AbstractProfileFormat
 public:
 	ProfileFormatG9 (const Sensor &sensor);
 
-	virtual const std::map<std::string, HIDPP::SettingDesc> &generalSettings () const;
-	virtual const std::map<std::string, HIDPP::SettingDesc> &modeSettings () const;
+	struct GeneralSetting
+	{
+		enum: std::size_t
+		{
+			Color,
+			Unknown0,
+			DefaultDPI,
+			DefaultDPIBit7,
+			Unknown1,
+			Unknown2,
+			ReportRate,
+			Unknown3,
+			Unknown4,
+			Unknown5,
+			Count
+		};
+	};
+	struct ModeSetting
+	{
+		enum: std::size_t
+		{
+			DPI,
+			LEDs,
+			Count
+		};
+	};
+
+	virtual HIDPP::SettingSchema generalSettings () const;
+	virtual HIDPP::SettingSchema modeSettings () const;
 	virtual const HIDPP::EnumDesc &specialActions () const;
 
 	virtual HIDPP::Profile read (std::vector<uint8_t>::const_iterator begin) const;
 	virtual void write (const HIDPP::Profile &profile, std::vector<uint8_t>::iterator begin) const;
 
+	/**
+	 * Read-only access to the fields of the profile beginning at \p begin
+	 * without decoding the whole profile.
+	 *
+	 * The view does not copy the profile, the memory must stay valid and
+	 * unmoved while it is used. Resolutions are converted with the sensor.
+	 */
+	class ConstView
+	{
+	public:
+		ConstView (const ProfileFormatG9 &format, std::vector<uint8_t>::const_iterator begin);
+
+		HIDPP::Color color () const;
+		/**
+		 * Number of enabled modes.
+		 */
+		unsigned int modeCount () const;
+		int dpi (unsigned int mode) const;
+		/**
+		 * Default mode index, without the unknown bit 7.
+		 */
+		int defaultDPI () const;
+		int reportRate () const;
+		HIDPP::Profile::Button button (unsigned int index) const;
+
+	protected:
+		const ProfileFormatG9 &_format;
+		std::vector<uint8_t>::const_iterator _begin;
+	};
+
+	/**
+	 * Same as ConstView but also modifies the fields in place.
+	 *
+	 * Values are not checked against the setting descriptions.
+	 */
+	class View: public ConstView
+	{
+	public:
+		View (const ProfileFormatG9 &format, std::vector<uint8_t>::iterator begin);
+
+		void setColor (HIDPP::Color color) const;
+		/**
+		 * Enabled modes end at the first mode with a zero resolution (see
+		 * modeCount), so a non-zero resolution only enables a disabled mode
+		 * if every mode before it is enabled.
+		 */
+		void setDPI (unsigned int mode, int dpi) const;
+		/**
+		 * Change the default mode index, bit 7 is kept.
+		 */
+		void setDefaultDPI (int index) const;
+		void setReportRate (int report_rate) const;
+		void setButton (unsigned int index, const HIDPP::Profile::Button &button) const;
+
+	private:
+		std::vector<uint8_t>::iterator _wbegin;
+	};
+
+	ConstView view (std::vector<uint8_t>::const_iterator begin) const;
+	View view (std::vector<uint8_t>::iterator begin) const;
+
 private:
 	const Sensor &_sensor;
 	HIDPP::SettingDesc _dpi_setting;
-	std::map<std::string, HIDPP::SettingDesc> _mode_settings;
+	HIDPP::SettingSchema::Entry _mode_settings[ModeSetting::Count];
 
 	static constexpr size_t ProfileSize = 56;
 	static constexpr unsigned int MaxButtonCount = 10;
 	static constexpr unsigned int MaxModeCount = 5;
 	static constexpr unsigned int LEDCount = 4;
 
-	static const std::map<std::string, HIDPP::SettingDesc> GeneralSettings;
+	static const HIDPP::SettingSchema::Entry GeneralSettings[GeneralSetting::Count];
 	static const HIDPP::EnumDesc SpecialActions;
 };
 
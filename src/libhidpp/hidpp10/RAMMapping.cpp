@@ -24,10 +24,25 @@
 using namespace HIDPP;
 using namespace HIDPP10;
 
-RAMMapping::RAMMapping (Device *dev):
+/*
+ * Starting a new write costs a sequence number reset and a first packet
+ * carrying only 7 data bytes, while rewriting unchanged bytes costs one
+ * packet every 16 bytes. Ranges separated by less than this gap are
+ * cheaper to write together.
+ */
+static constexpr std::size_t MergeGap = 32;
+
+RAMMapping::RAMMapping (Device *dev, bool diff_writes):
 	AbstractMemoryMapping (false),
-	_imem (dev)
+	_imem (dev),
+	_diff_writes (diff_writes)
+{
+	setPageLayout (1, 1, RAMSize);
+}
+
+RAMMapping::~RAMMapping ()
 {
+	stopStreaming ();
 }
 
 std::vector<uint8_t>::const_iterator RAMMapping::getReadOnlyIterator (const Address &address)
@@ -57,12 +72,42 @@ void RAMMapping::readPage (const Address &address, std::vector<uint8_t> &data)
 	if (address.page != 0)
 		throw std::out_of_range ("RAM address page");
 	data.resize (RAMSize);
-	_imem.readMem (address, data);
+	_imem.readMem (address, data, readWindow ());
 }
 
 void RAMMapping::writePage (const Address &address, const std::vector<uint8_t> &data)
 {
 	if (address.page != 0)
 		throw std::out_of_range ("RAM address page");
-	_imem.writeMem (address, data);
+	_imem.writeMem (address, data, writeWindow ());
+}
+
+std::size_t RAMMapping::lineSize () const
+{
+	// RAM is addressed by 16 bits words
+	return _diff_writes ? 2 : RAMSize;
+}
+
+void RAMMapping::writePageRanges (const Address &address, const std::vector<uint8_t> &data,
+				  const std::vector<Range> &ranges)
+{
+	if (!_diff_writes)
+		return writePage (address, data);
+	if (address.page != 0)
+		throw std::out_of_range ("RAM address page");
+
+	std::vector<Range> merged;
+	for (const auto &range: ranges) {
+		if (!merged.empty () && range.first - merged.back ().second < MergeGap)
+			merged.back ().second = range.second;
+		else
+			merged.push_back (range);
+	}
+	auto debug = Log::debug ("memory");
+	for (const auto &range: merged) {
+		debug.printf ("Writing RAM bytes %zu to %zu\n", range.first, range.second);
+		std::vector<uint8_t> chunk (data.begin () + range.first, data.begin () + range.second);
+		_imem.writeMem ({ address.mem_type, address.page, static_cast<unsigned int> (range.first/2) },
+				 chunk, writeWindow ());
+	}
 }
@@ -29,7 +29,14 @@ namespace HIDPP10
 class RAMMapping: public HIDPP::AbstractMemoryMapping
 {
 public:
-	RAMMapping (Device *dev);
+	/**
+	 * \param dev		Device whose RAM is mapped.
+	 * \param diff_writes	Only write the changed byte ranges when syncing,
+	 *			nearby ranges are merged to limit the number of
+	 *			data packets.
+	 */
+	RAMMapping (Device *dev, bool diff_writes = false);
+	~RAMMapping ();
 
 	virtual std::vector<uint8_t>::const_iterator getReadOnlyIterator (const HIDPP::Address &address);
 	virtual std::vector<uint8_t>::iterator getWritableIterator (const HIDPP::Address &address);
@@ -38,9 +45,13 @@ public:
 protected:
 	virtual void readPage (const HIDPP::Address &address, std::vector<uint8_t> &data);
 	virtual void writePage (const HIDPP::Address &address, const std::vector<uint8_t> &data);
+	virtual std::size_t lineSize () const;
+	virtual void writePageRanges (const HIDPP::Address &address, const std::vector<uint8_t> &data,
+				      const std::vector<Range> &ranges);
 
 private:
 	IMemory _imem;
+	bool _diff_writes;
 };
 
 }
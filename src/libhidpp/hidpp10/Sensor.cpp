@@ -52,9 +52,9 @@ unsigned int ListSensor::fromDPI (unsigned int dpi) const
 			unsigned int mid = (high + low)/2;
 			unsigned int mid_dpi = _resolutions[mid];
 			if (dpi < mid_dpi)
-				high = mid_dpi;
+				high = mid;
 			else
-				low = mid_dpi;
+				low = mid;
 		}
 		if (_resolutions[high]-dpi < dpi-_resolutions[low])
 			nearest = high;
@@ -0,0 +1,163 @@
+/*
+ * Copyright 2026 Clément Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "BatteryMonitor.h"
+
+#include <misc/Log.h>
+
+#include <vector>
+
+using namespace HIDPP20;
+
+BatteryMonitor::BatteryMonitor (clock::duration max_age):
+	_max_age (max_age)
+{
+}
+
+BatteryMonitor::~BatteryMonitor ()
+{
+	std::map<Device *, Entry> devices;
+	{
+		std::unique_lock<std::mutex> lock (_mutex);
+		devices.swap (_devices);
+	}
+	for (auto &p: devices)
+		p.first->dispatcher ()->unregisterEventHandler (p.second.listener);
+}
+
+void BatteryMonitor::addDevice (Device *dev)
+{
+	{
+		std::unique_lock<std::mutex> lock (_mutex);
+		if (_devices.find (dev) != _devices.end ())
+			return;
+	}
+	// Never hold the lock while using the dispatcher: event handlers
+	// lock it from the dispatcher thread.
+	IBatteryLevelStatus feature (dev);
+	auto dispatcher = dev->dispatcher ();
+	auto listener = dispatcher->registerEventHandler (dev->deviceIndex (), feature.index (),
+			std::bind (&BatteryMonitor::event, this, dev, std::placeholders::_1));
+	IBatteryLevelStatus::LevelStatus level_status;
+	try {
+		level_status = feature.getLevelStatus ();
+	}
+	catch (...) {
+		dispatcher->unregisterEventHandler (listener);
+		throw;
+	}
+	bool inserted;
+	{
+		std::unique_lock<std::mutex> lock (_mutex);
+		inserted = _devices.emplace (dev, Entry { feature, listener, Status { level_status, clock::now () } }).second;
+	}
+	// The device was added concurrently, keep only the first listener
+	if (!inserted)
+		dispatcher->unregisterEventHandler (listener);
+}
+
+void BatteryMonitor::removeDevice (Device *dev)
+{
+	HIDPP::Dispatcher::listener_iterator listener;
+	{
+		std::unique_lock<std::mutex> lock (_mutex);
+		auto it = _devices.find (dev);
+		if (it == _devices.end ())
+			return;
+		listener = it->second.listener;
+		_devices.erase (it);
+	}
+	dev->dispatcher ()->unregisterEventHandler (listener);
+}
+
+std::optional<BatteryMonitor::Status> BatteryMonitor::cachedStatus (Device *dev) const
+{
+	std::unique_lock<std::mutex> lock (_mutex);
+	auto it = _devices.find (dev);
+	if (it == _devices.end ())
+		return std::nullopt;
+	return it->second.status;
+}
+
+BatteryMonitor::Status BatteryMonitor::status (Device *dev)
+{
+	{
+		std::unique_lock<std::mutex> lock (_mutex);
+		const auto &status = _devices.at (dev).status;
+		if (!isStale (status, clock::now ()))
+			return status;
+	}
+	query (dev);
+	std::unique_lock<std::mutex> lock (_mutex);
+	return _devices.at (dev).status;
+}
+
+void BatteryMonitor::refreshStale ()
+{
+	std::vector<Device *> stale;
+	{
+		std::unique_lock<std::mutex> lock (_mutex);
+		auto now = clock::now ();
+		for (const auto &p: _devices)
+			if (isStale (p.second.status, now))
+				stale.push_back (p.first);
+	}
+	for (auto dev: stale) {
+		try {
+			query (dev);
+		}
+		catch (std::exception &e) {
+			Log::warning ().printf ("Failed to query battery status of device %d: %s\n",
+						dev->deviceIndex (), e.what ());
+		}
+	}
+}
+
+bool BatteryMonitor::isStale (const Status &status, clock::time_point now) const
+{
+	return now - status.last_update > _max_age;
+}
+
+void BatteryMonitor::query (Device *dev)
+{
+	std::optional<IBatteryLevelStatus> feature;
+	{
+		std::unique_lock<std::mutex> lock (_mutex);
+		feature.emplace (_devices.at (dev).feature);
+	}
+	auto level_status = feature->getLevelStatus ();
+	std::unique_lock<std::mutex> lock (_mutex);
+	auto it = _devices.find (dev);
+	if (it != _devices.end ())
+		it->second.status = Status { level_status, clock::now () };
+}
+
+bool BatteryMonitor::event (Device *dev, const HIDPP::Report &report)
+{
+	if (report.function () != IBatteryLevelStatus::BatteryLevelEvent || report.softwareID () != 0)
+		return true;
+	auto level_status = IBatteryLevelStatus::batteryLevelEvent (report);
+	std::unique_lock<std::mutex> lock (_mutex);
+	auto it = _devices.find (dev);
+	if (it != _devices.end ()) {
+		it->second.status = Status { level_status, clock::now () };
+		Log::debug ("battery").printf ("Device %d battery level is %d%%\n",
+					       dev->deviceIndex (), level_status.discharge_level);
+	}
+	return true;
+}
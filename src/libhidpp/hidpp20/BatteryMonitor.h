@@ -0,0 +1,117 @@
+/*
+ * Copyright 2026 Clément Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef LIBHIDPP_HIDPP20_BATTERY_MONITOR_H
+#define LIBHIDPP_HIDPP20_BATTERY_MONITOR_H
+
+#include <hidpp/Dispatcher.h>
+#include <hidpp20/IBatteryLevelStatus.h>
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <optional>
+
+namespace HIDPP20
+{
+
+/**
+ * Cache the battery status of several devices.
+ *
+ * The status is queried once when the device is added, then it is
+ * updated from IBatteryLevelStatus::BatteryLevelEvent notifications.
+ * Reading the status of a device is a local read, the device is only
+ * queried again when the last known status is older than the maximum
+ * age given to the constructor.
+ *
+ * Notifications are only processed while the device dispatcher reads
+ * reports: use a DispatcherThread to keep the cache up to date.
+ */
+class BatteryMonitor
+{
+public:
+	typedef std::chrono::steady_clock clock;
+
+	struct Status
+	{
+		IBatteryLevelStatus::LevelStatus level_status;
+		clock::time_point last_update;
+	};
+
+	/**
+	 * \param max_age	Age after which a status is queried again by status().
+	 */
+	BatteryMonitor (clock::duration max_age = std::chrono::hours (1));
+	~BatteryMonitor ();
+
+	BatteryMonitor (const BatteryMonitor &) = delete;
+	BatteryMonitor &operator= (const BatteryMonitor &) = delete;
+
+	/**
+	 * Start monitoring \p dev and query its current status.
+	 *
+	 * Adding a device that is already monitored does nothing.
+	 *
+	 * \p dev must stay valid until it is removed or the monitor is destroyed.
+	 *
+	 * \throws UnsupportedFeature if the device has no battery feature.
+	 */
+	void addDevice (Device *dev);
+	/**
+	 * Stop monitoring \p dev.
+	 */
+	void removeDevice (Device *dev);
+
+	/**
+	 * Get the last known status without any communication with the device.
+	 *
+	 * \returns std::nullopt if the device is not monitored.
+	 */
+	std::optional<Status> cachedStatus (Device *dev) const;
+
+	/**
+	 * Get the status of \p dev, querying the device only if the cached
+	 * status is stale.
+	 */
+	Status status (Device *dev);
+
+	/**
+	 * Query every device whose status is stale.
+	 */
+	void refreshStale ();
+
+private:
+	struct Entry
+	{
+		IBatteryLevelStatus feature;
+		HIDPP::Dispatcher::listener_iterator listener;
+		Status status;
+	};
+
+	bool isStale (const Status &status, clock::time_point now) const;
+	void query (Device *dev);
+	bool event (Device *dev, const HIDPP::Report &report);
+
+	clock::duration _max_age;
+	mutable std::mutex _mutex;
+	std::map<Device *, Entry> _devices;
+};
+
+}
+
+#endif
@@ -46,19 +46,70 @@ std::vector<uint8_t> Device::callFunction (uint8_t feature_index,
 					   std::vector<uint8_t>::const_iterator param_begin,
 					   std::vector<uint8_t>::const_iterator param_end)
 {
-	auto debug = Log::debug ("call");
-	debug.printf ("Calling feature 0x%02hhx/function %u\n", feature_index, function);
-	debug.printBytes ("Parameters:", param_begin, param_end);
+	auto request = createRequest (feature_index, function, std::distance (param_begin, param_end));
+	std::copy (param_begin, param_end, request.parameterBegin ());
+	auto response = sendRequest (std::move (request));
+	return std::vector<uint8_t> (response.parameterBegin (), response.parameterEnd ());
+}
 
-	std::size_t len = std::distance (param_begin, param_end);
-	auto type = dispatcher ()->reportInfo ().findReport (len);
+HIDPP::Report Device::createRequest (uint8_t feature_index,
+				     unsigned int function,
+				     std::size_t param_length)
+{
+	auto type = dispatcher ()->reportInfo ().findReport (param_length);
 	if (!type)
 		throw std::logic_error ("Parameters too long");
-	HIDPP::Report request (*type, deviceIndex (), feature_index, function, softwareID);
-	std::copy (param_begin, param_end, request.parameterBegin ());
+	return HIDPP::Report (*type, deviceIndex (), feature_index, function, softwareID);
+}
+
+HIDPP::Report Device::sendRequest (HIDPP::Report &&request)
+{
+	auto debug = Log::debug ("call");
+	debug.printf ("Calling feature 0x%02hhx/function %u\n", request.featureIndex (), request.function ());
+	debug.printBytes ("Parameters:", request.parameterBegin (), request.parameterEnd ());
 
 	auto response = dispatcher ()->sendCommand (std::move (request))->get ();
 
 	debug.printBytes ("Results:", response.parameterBegin (), response.parameterEnd ());
+	return response;
+}
+
+std::vector<uint8_t> Device::callCachedFunction (uint8_t feature_index,
+						 unsigned int function,
+						 std::vector<uint8_t>::const_iterator param_begin,
+						 std::vector<uint8_t>::const_iterator param_end)
+{
+	auto request = createRequest (feature_index, function, std::distance (param_begin, param_end));
+	std::copy (param_begin, param_end, request.parameterBegin ());
+	auto response = sendCachedRequest (std::move (request));
 	return std::vector<uint8_t> (response.parameterBegin (), response.parameterEnd ());
 }
+
+HIDPP::Report Device::sendCachedRequest (HIDPP::Report &&request)
+{
+	cache_key key (request.featureIndex (), request.function (),
+		       std::vector<uint8_t> (request.parameterBegin (), request.parameterEnd ()));
+	auto it = _cache.find (key);
+	if (it != _cache.end ()) {
+		Log::debug ("call").printf ("Using cached result for feature 0x%02hhx/function %u\n",
+					    request.featureIndex (), request.function ());
+		return it->second;
+	}
+	auto response = sendRequest (std::move (request));
+	_cache.emplace (std::move (key), response);
+	return response;
+}
+
+void Device::invalidateCache ()
+{
+	_cache.clear ();
+}
+
+void Device::invalidateCache (uint8_t feature_index)
+{
+	auto begin = _cache.lower_bound (cache_key (feature_index, 0, {}));
+	auto end = _cache.lower_bound (cache_key (feature_index+1, 0, {}));
+	if (feature_index == 0xff)
+		end = _cache.end ();
+	_cache.erase (begin, end);
+}
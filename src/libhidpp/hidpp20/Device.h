@@ -20,6 +20,10 @@
 #define LIBHIDPP_HIDPP20_DEVICE_H
 
 #include <hidpp/Device.h>
+#include <hidpp/Report.h>
+
+#include <map>
+#include <tuple>
 
 namespace HIDPP { class Dispatcher; }
 
@@ -43,6 +47,63 @@ public:
 	{
 		return callFunction (feature_index, function, params.begin (), params.end ());
 	}
+
+	/**
+	 * Build a request report for \p function with room for at least
+	 * \p param_length bytes of parameters (filled with zeroes).
+	 *
+	 * \see sendRequest
+	 */
+	HIDPP::Report createRequest (uint8_t feature_index,
+				     unsigned int function,
+				     std::size_t param_length = 0);
+
+	/**
+	 * Send a request built with createRequest and wait for the response.
+	 *
+	 * \returns the complete response report.
+	 */
+	HIDPP::Report sendRequest (HIDPP::Report &&request);
+
+	/**
+	 * \name Memoized calls
+	 *
+	 * Same as callFunction and sendRequest but the response is memoized
+	 * and later identical requests are answered without communicating
+	 * with the device.
+	 *
+	 * Only use them for queries whose results never change for a given
+	 * firmware (descriptions, counts, capabilities, feature indexes).
+	 *
+	 * \{
+	 */
+	std::vector<uint8_t> callCachedFunction (uint8_t feature_index,
+						 unsigned int function,
+						 std::vector<uint8_t>::const_iterator param_begin,
+						 std::vector<uint8_t>::const_iterator param_end);
+
+	inline std::vector<uint8_t> callCachedFunction (uint8_t feature_index,
+							unsigned int function,
+							const std::vector<uint8_t> params = {})
+	{
+		return callCachedFunction (feature_index, function, params.begin (), params.end ());
+	}
+
+	HIDPP::Report sendCachedRequest (HIDPP::Report &&request);
+
+	/**
+	 * Forget every memoized response (e.g. after a firmware update).
+	 */
+	void invalidateCache ();
+	/**
+	 * Forget the memoized responses for the feature at \p feature_index.
+	 */
+	void invalidateCache (uint8_t feature_index);
+	/**\}*/
+
+private:
+	typedef std::tuple<uint8_t, unsigned int, std::vector<uint8_t>> cache_key;
+	std::map<cache_key, HIDPP::Report> _cache;
 };
 
 }
@@ -20,6 +20,7 @@
 #define LIBHIDPP_HIDPP20_FEATURE_INTERFACE_H
 
 #include <hidpp20/Device.h>
+#include <hidpp20/FunctionSignature.h>
 
 #include <cstdint>
 #include <vector>
@@ -42,6 +43,30 @@ public:
 		return _dev->callFunction (_index, function, params...);
 	}
 
+	template<typename Request, typename Response, typename... Args>
+	typename Response::values_type call (const FunctionSignature<Request, Response> &signature, const Args &... args)
+	{
+		return callFunction (_dev, _index, signature, args...);
+	}
+
+	/**
+	 * Call a function whose results never change, the response is
+	 * memoized by the device.
+	 *
+	 * \see Device::callCachedFunction
+	 */
+	template<typename... Params>
+	std::vector<uint8_t> callCached (unsigned int function, Params... params)
+	{
+		return _dev->callCachedFunction (_index, function, params...);
+	}
+
+	template<typename Request, typename Response, typename... Args>
+	typename Response::values_type callCached (const FunctionSignature<Request, Response> &signature, const Args &... args)
+	{
+		return callCachedFunction (_dev, _index, signature, args...);
+	}
+
 private:
 	Device *_dev;
 	uint8_t _index;
@@ -0,0 +1,157 @@
+/*
+ * Copyright 2026 Clément Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef LIBHIDPP_HIDPP20_FUNCTION_SIGNATURE_H
+#define LIBHIDPP_HIDPP20_FUNCTION_SIGNATURE_H
+
+#include <hidpp/Field.h>
+#include <hidpp20/Device.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+namespace HIDPP20
+{
+
+/**
+ * Layout of the parameters of a HID++ 2.0 request or response.
+ *
+ * It is a list of fields from hidpp/Field.h (Field or ArrayField),
+ * values are read and written in the same order as the fields.
+ *
+ *     static constexpr auto Layout = ParameterLayout (
+ *         Field<uint8_t> (0),
+ *         Field<uint16_t, BigEndian> (1));
+ */
+template<typename... Fields>
+class ParameterLayout
+{
+public:
+	typedef std::tuple<typename Fields::value_type...> values_type;
+
+	constexpr ParameterLayout (Fields... fields):
+		_fields (fields...)
+	{
+	}
+
+	/**
+	 * Minimum parameter length for containing every field.
+	 */
+	constexpr std::size_t length () const
+	{
+		return std::apply ([] (const auto &... fields) {
+			return std::max<std::size_t> ({ 0, (fields.offset + fields.size)... });
+		}, _fields);
+	}
+
+	void write (std::vector<uint8_t>::iterator it, const typename Fields::value_type &... values) const
+	{
+		write (it, std::index_sequence_for<Fields...> (), values...);
+	}
+
+	values_type read (std::vector<uint8_t>::const_iterator it) const
+	{
+		return read (it, std::index_sequence_for<Fields...> ());
+	}
+
+private:
+	template<std::size_t... I>
+	void write ([[maybe_unused]] std::vector<uint8_t>::iterator it, std::index_sequence<I...>,
+		    const typename Fields::value_type &... values) const
+	{
+		(std::get<I> (_fields).write (it, values), ...);
+	}
+
+	template<std::size_t... I>
+	values_type read ([[maybe_unused]] std::vector<uint8_t>::const_iterator it, std::index_sequence<I...>) const
+	{
+		return values_type (std::get<I> (_fields).read (it)...);
+	}
+
+	std::tuple<Fields...> _fields;
+};
+
+/**
+ * Declaration of a feature function: its index and the layouts of its
+ * request and response parameters.
+ *
+ * Calling it with callFunction() writes the parameters directly in the
+ * request report and reads the results directly from the response
+ * report.
+ */
+template<typename Request, typename Response>
+class FunctionSignature
+{
+public:
+	typedef typename Response::values_type result_type;
+
+	unsigned int function;
+	Request request;
+	Response response;
+
+	constexpr FunctionSignature (unsigned int function, Request request, Response response):
+		function (function), request (request), response (response)
+	{
+	}
+};
+
+/**
+ * Call the function described by \p signature on feature \p feature_index.
+ *
+ * \returns the values read from the response in the order of the response layout.
+ */
+template<typename Request, typename Response, typename... Args>
+typename Response::values_type
+callFunction (Device *dev, uint8_t feature_index,
+	      const FunctionSignature<Request, Response> &signature,
+	      const Args &... args)
+{
+	auto request = dev->createRequest (feature_index, signature.function,
+					   signature.request.length ());
+	signature.request.write (request.parameterBegin (), args...);
+	auto response = dev->sendRequest (std::move (request));
+	if (response.parameterLength () < signature.response.length ())
+		throw std::runtime_error ("Response is too short");
+	return signature.response.read (response.parameterBegin ());
+}
+
+/**
+ * Same as callFunction but the response is memoized by the device.
+ *
+ * \see Device::sendCachedRequest
+ */
+template<typename Request, typename Response, typename... Args>
+typename Response::values_type
+callCachedFunction (Device *dev, uint8_t feature_index,
+		    const FunctionSignature<Request, Response> &signature,
+		    const Args &... args)
+{
+	auto request = dev->createRequest (feature_index, signature.function,
+					   signature.request.length ());
+	signature.request.write (request.parameterBegin (), args...);
+	auto response = dev->sendCachedRequest (std::move (request));
+	if (response.parameterLength () < signature.response.length ())
+		throw std::runtime_error ("Response is too short");
+	return signature.response.read (response.parameterBegin ());
+}
+
+}
+
+#endif
@@ -32,7 +32,7 @@ IAdjustableDPI::IAdjustableDPI (Device *dev):
 unsigned int IAdjustableDPI::getSensorCount ()
 {
 	std::vector<uint8_t> results;
-	results = call (GetSensorCount);
+	results = callCached (GetSensorCount);
 	return results[0];
 }
 
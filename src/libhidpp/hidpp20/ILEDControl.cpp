@@ -34,7 +34,7 @@ ILEDControl::ILEDControl (Device *dev):
 unsigned int ILEDControl::getCount()
 {
 	std::vector<uint8_t> results;
-	results = call (GetCount);
+	results = callCached (GetCount);
 	return results[0];
 }
 
@@ -42,7 +42,7 @@ ILEDControl::Info ILEDControl::getInfo(unsigned int led_index)
 {
 	std::vector<uint8_t> params (1), results;
 	params[0] = led_index;
-	results = call (GetInfo, params);
+	results = callCached (GetInfo, params);
 	return Info {
 		static_cast<Type> (results[1]), // type
 		results[2], // physical count
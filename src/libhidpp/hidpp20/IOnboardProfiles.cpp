@@ -18,12 +18,32 @@
 
 #include <hidpp20/IOnboardProfiles.h>
 
+#include <hidpp20/Device.h>
+#include <hidpp/CommandPipeline.h>
 #include <misc/Endian.h>
 
+#include <algorithm>
 #include <cassert>
+#include <stdexcept>
+#include <tuple>
 
+using namespace HIDPP;
 using namespace HIDPP20;
 
+namespace Signatures
+{
+static constexpr auto GetDescription = FunctionSignature (IOnboardProfiles::GetDescription,
+	ParameterLayout (),
+	ParameterLayout (
+		Field<uint8_t> (0), // Memory model
+		Field<uint8_t> (1), // Profile format
+		Field<uint8_t> (2), // Macro format
+		Field<uint8_t> (3), Field<uint8_t> (4), // Profile counts
+		Field<uint8_t> (5), // Button count
+		Field<uint8_t> (6), Field<uint16_t, BigEndian> (7), // Sector (page) count and size
+		Field<uint8_t> (9), Field<uint8_t> (10)));
+}
+
 constexpr uint16_t IOnboardProfiles::ID;
 
 IOnboardProfiles::IOnboardProfiles (Device *dev):
@@ -33,17 +53,9 @@ IOnboardProfiles::IOnboardProfiles (Device *dev):
 
 IOnboardProfiles::Description IOnboardProfiles::getDescription ()
 {
-	std::vector<uint8_t> results;
-	results = call (GetDescription);
-	return Description {
-		results[0], // Memory model
-		results[1], // Profile format
-		results[2], // Macro format
-		results[3], results[4], // Profile counts
-		results[5], // Button count
-		results[6], readBE<uint16_t> (results, 7), // Sector (page) count and size
-		results[9], results[10]
-	};
+	return std::apply ([] (auto... values) {
+		return Description { values... };
+	}, callCached (Signatures::GetDescription));
 }
 
 IOnboardProfiles::Mode IOnboardProfiles::getMode ()
@@ -84,6 +96,45 @@ std::vector<uint8_t> IOnboardProfiles::memoryRead (MemoryType mem_type, unsigned
 	return call (MemoryRead, params);
 }
 
+std::vector<uint8_t> IOnboardProfiles::memoryRead (MemoryType mem_type, unsigned int page, unsigned int offset,
+						   unsigned int length, unsigned int window)
+{
+	auto data = memoryRead ({{ mem_type, page, offset, length }}, window);
+	return std::move (data.front ());
+}
+
+std::vector<std::vector<uint8_t>> IOnboardProfiles::memoryRead (const std::vector<MemoryRange> &ranges,
+								unsigned int window)
+{
+	auto dev = device ();
+	// Map each line index to its range and offset in the range
+	std::vector<std::tuple<std::size_t, unsigned int>> lines;
+	std::vector<std::vector<uint8_t>> data (ranges.size ());
+	for (std::size_t i = 0; i < ranges.size (); ++i) {
+		unsigned int line_count = (ranges[i].length + LineSize - 1) / LineSize;
+		data[i].resize (line_count * LineSize);
+		for (unsigned int j = 0; j < line_count; ++j)
+			lines.emplace_back (i, j*LineSize);
+	}
+	sendPipelinedCommands (dev->dispatcher (), window, lines.size (),
+		[&] (std::size_t i) {
+			auto [range, offset] = lines[i];
+			auto request = dev->createRequest (index (), MemoryRead, 4);
+			auto params = request.parameterBegin ();
+			params[0] = ranges[range].mem_type;
+			params[1] = ranges[range].page;
+			writeBE<uint16_t> (params+2, ranges[range].offset + offset);
+			return request;
+		},
+		[&] (std::size_t i, HIDPP::Report &&response) {
+			auto [range, offset] = lines[i];
+			if (response.parameterLength () < LineSize)
+				throw std::runtime_error ("Memory read response is too short");
+			std::copy_n (response.parameterBegin (), LineSize, &data[range][offset]);
+		});
+	return data;
+}
+
 void IOnboardProfiles::memoryAddrWrite (unsigned int page, unsigned int offset, unsigned int length)
 {
 	std::vector<uint8_t> params (6);
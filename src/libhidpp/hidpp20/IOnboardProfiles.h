@@ -195,6 +195,35 @@ public:
 	 * Read \ref LineSize bytes from the given address.
 	 */
 	std::vector<uint8_t> memoryRead (MemoryType mem_type, unsigned int page, unsigned int offset);
+	/**
+	 * Read \p length bytes from the given address, \ref LineSize bytes
+	 * at a time, keeping up to \p window requests in flight.
+	 *
+	 * \p length is rounded up to a multiple of \ref LineSize.
+	 *
+	 * \see HIDPP::sendPipelinedCommands
+	 */
+	std::vector<uint8_t> memoryRead (MemoryType mem_type, unsigned int page, unsigned int offset,
+					 unsigned int length, unsigned int window);
+
+	struct MemoryRange
+	{
+		MemoryType mem_type;
+		unsigned int page;
+		unsigned int offset;
+		unsigned int length;
+	};
+	/**
+	 * Read several memory ranges in a single pipeline.
+	 *
+	 * Requests for the next range are sent while the previous one is
+	 * still being read, so reading N pages costs the same number of
+	 * round trips as one long page.
+	 *
+	 * \returns the data for each range, rounded up to \ref LineSize.
+	 */
+	std::vector<std::vector<uint8_t>> memoryRead (const std::vector<MemoryRange> &ranges,
+						      unsigned int window);
 	/**
 	 * Initiate writing to the memory.
 	 *
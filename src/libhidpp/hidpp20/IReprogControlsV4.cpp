@@ -33,7 +33,7 @@ IReprogControlsV4::IReprogControlsV4 (Device *dev):
 unsigned int IReprogControlsV4::getControlCount ()
 {
 	std::vector<uint8_t> results;
-	results = call (GetControlCount);
+	results = callCached (GetControlCount);
 	return results[0];
 }
 
@@ -41,7 +41,7 @@ IReprogControlsV4::ControlInfo IReprogControlsV4::getControlInfo (unsigned int i
 {
 	std::vector<uint8_t> params (1), results;
 	params[0] = index;
-	results = call (GetControlInfo, params);
+	results = callCached (GetControlInfo, params);
 	ControlInfo ci;
 	ci.control_id = readBE<uint16_t> (results, 0);
 	ci.task_id = readBE<uint16_t> (results, 2);
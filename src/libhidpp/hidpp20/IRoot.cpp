@@ -19,11 +19,18 @@
 #include <hidpp20/IRoot.h>
 
 #include <hidpp20/Device.h>
+#include <hidpp20/FunctionSignature.h>
 
-#include <misc/Endian.h>
-
+using namespace HIDPP;
 using namespace HIDPP20;
 
+namespace Signatures
+{
+static constexpr auto GetFeature = FunctionSignature (IRoot::GetFeature,
+	ParameterLayout (Field<uint16_t, BigEndian> (0)), // feature ID
+	ParameterLayout (Field<uint8_t> (0), Field<uint8_t> (1))); // feature index, feature type
+}
+
 constexpr uint16_t IRoot::ID;
 
 IRoot::IRoot (Device *dev):
@@ -35,13 +42,11 @@ uint8_t IRoot::getFeature (uint16_t feature_id,
 			   bool *obsolete,
 			   bool *hidden)
 {
-	std::vector<uint8_t> params (2), results;
-	writeBE<uint16_t> (params, 0, feature_id);
-	results = _dev->callFunction (index, GetFeature, params);
+	auto [feature_index, feature_type] = callCachedFunction (_dev, index, Signatures::GetFeature, feature_id);
 	if (obsolete)
-		*obsolete = results[1] & (1<<7);
+		*obsolete = feature_type & (1<<7);
 	if (hidden)
-		*hidden = results[1] & (1<<6);
-	return results[0];
+		*hidden = feature_type & (1<<6);
+	return feature_index;
 }
 
@@ -32,7 +32,7 @@ ITouchpadRawXY::ITouchpadRawXY (Device *dev):
 
 ITouchpadRawXY::TouchpadInfo ITouchpadRawXY::getTouchpadInfo ()
 {
-	auto results = call (GetTouchpadInfo);
+	auto results = callCached (GetTouchpadInfo);
 	TouchpadInfo info;
 	info.x_max = readBE<uint16_t> (results, 0);
 	info.y_max = readBE<uint16_t> (results, 2);
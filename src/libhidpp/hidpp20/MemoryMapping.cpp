@@ -29,6 +29,13 @@ MemoryMapping::MemoryMapping (Device *dev, bool write_crc):
 	_iop (dev),
 	_desc (_iop.getDescription ())
 {
+	// Writeable and ROM memory types
+	setPageLayout (2, _desc.sector_count, _desc.sector_size);
+}
+
+MemoryMapping::~MemoryMapping ()
+{
+	stopStreaming ();
 }
 
 std::vector<uint8_t>::const_iterator MemoryMapping::getReadOnlyIterator (const Address &address)
@@ -53,11 +60,34 @@ bool MemoryMapping::computeOffset (std::vector<uint8_t>::const_iterator it, Addr
 
 void MemoryMapping::readPage (const Address &address, std::vector<uint8_t> &data)
 {
+	data = _iop.memoryRead (static_cast<IOnboardProfiles::MemoryType> (address.mem_type),
+				address.page, 0, _desc.sector_size, readWindow ());
 	data.resize (_desc.sector_size);
-	for (unsigned int i = 0; i < _desc.sector_size; i += IOnboardProfiles::LineSize) {
-		auto vec = _iop.memoryRead (static_cast<IOnboardProfiles::MemoryType> (address.mem_type), address.page, i);
-		std::copy_n (vec.begin (), IOnboardProfiles::LineSize, &data[i]);
-	}
+}
+
+void MemoryMapping::readPages (const std::vector<Address> &addresses, std::vector<std::vector<uint8_t>> &data)
+{
+	std::vector<IOnboardProfiles::MemoryRange> ranges;
+	for (const auto &address: addresses)
+		ranges.push_back ({ static_cast<IOnboardProfiles::MemoryType> (address.mem_type),
+				    address.page, 0, _desc.sector_size });
+	data = _iop.memoryRead (ranges, readWindow ());
+	for (auto &page: data)
+		page.resize (_desc.sector_size);
+}
+
+void MemoryMapping::readPageRanges (const Address &address, std::vector<uint8_t> &data,
+				    const std::vector<Range> &ranges)
+{
+	std::vector<IOnboardProfiles::MemoryRange> mem_ranges;
+	for (const auto &range: ranges)
+		mem_ranges.push_back ({ static_cast<IOnboardProfiles::MemoryType> (address.mem_type),
+					address.page, static_cast<unsigned int> (range.first),
+					static_cast<unsigned int> (range.second - range.first) });
+	auto results = _iop.memoryRead (mem_ranges, readWindow ());
+	for (std::size_t i = 0; i < ranges.size (); ++i)
+		std::copy_n (results[i].begin (), ranges[i].second - ranges[i].first,
+			     data.begin () + ranges[i].first);
 }
 
 void MemoryMapping::writePage (const Address &address, const std::vector<uint8_t> &data)
@@ -71,3 +101,29 @@ void MemoryMapping::writePage (const Address &address, const std::vector<uint8_t
 	_iop.memoryWriteEnd ();
 }
 
+std::size_t MemoryMapping::lineSize () const
+{
+	return IOnboardProfiles::LineSize;
+}
+
+void MemoryMapping::writePageRanges (const Address &address, const std::vector<uint8_t> &data,
+				     const std::vector<Range> &ranges)
+{
+	assert (address.mem_type == IOnboardProfiles::Writeable);
+	if (ranges.empty ())
+		return;
+	/*
+	 * Each transaction commits the whole sector to flash, write a single
+	 * span from the first to the last modified line (usually the CRC) so
+	 * that the sector is erased once and never left with a stale CRC.
+	 */
+	constexpr size_t LineSize = IOnboardProfiles::LineSize;
+	size_t begin = ranges.front ().first, end = ranges.back ().second;
+	_iop.memoryAddrWrite (address.page, begin, end - begin);
+	for (size_t i = begin; i < end; i += LineSize) {
+		_iop.memoryWrite (data.begin () + i,
+				  data.begin () + std::min (i + LineSize, end));
+	}
+	_iop.memoryWriteEnd ();
+}
+
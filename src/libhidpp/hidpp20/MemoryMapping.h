@@ -29,6 +29,7 @@ class MemoryMapping: public HIDPP::AbstractMemoryMapping
 {
 public:
 	MemoryMapping (Device *dev, bool write_crc = true);
+	~MemoryMapping ();
 
 	virtual std::vector<uint8_t>::const_iterator getReadOnlyIterator (const HIDPP::Address &address);
 	virtual std::vector<uint8_t>::iterator getWritableIterator (const HIDPP::Address &address);
@@ -36,7 +37,13 @@ public:
 
 protected:
 	virtual void readPage (const HIDPP::Address &address, std::vector<uint8_t> &data);
+	virtual void readPages (const std::vector<HIDPP::Address> &addresses, std::vector<std::vector<uint8_t>> &data);
+	virtual void readPageRanges (const HIDPP::Address &address, std::vector<uint8_t> &data,
+				     const std::vector<Range> &ranges);
 	virtual void writePage (const HIDPP::Address &address, const std::vector<uint8_t> &data);
+	virtual std::size_t lineSize () const;
+	virtual void writePageRanges (const HIDPP::Address &address, const std::vector<uint8_t> &data,
+				      const std::vector<Range> &ranges);
 
 private:
 	IOnboardProfiles _iop;
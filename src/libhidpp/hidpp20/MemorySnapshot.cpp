@@ -0,0 +1,252 @@
+/*
+ * Copyright 2026 Clément Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "MemorySnapshot.h"
+
+#include <hidpp20/Device.h>
+#include <hidpp20/Error.h>
+#include <hidpp20/MemoryMapping.h>
+#include <hidpp/Dispatcher.h>
+#include <misc/CRC.h>
+#include <misc/Endian.h>
+#include <misc/Log.h>
+
+#include <algorithm>
+#include <stdexcept>
+
+using namespace HIDPP;
+using namespace HIDPP20;
+
+static constexpr char Magic[4] = { 'H', 'P', 'M', 'S' };
+
+static std::vector<MemorySnapshot::Sector> readSectors (IOnboardProfiles &iop,
+							const IOnboardProfiles::Description &desc,
+							IOnboardProfiles::MemoryType mem_type,
+							unsigned int window)
+{
+	std::vector<IOnboardProfiles::MemoryRange> ranges;
+	for (unsigned int page = 0; page < desc.sector_count; ++page)
+		ranges.push_back ({ mem_type, page, 0, desc.sector_size });
+	std::vector<std::vector<uint8_t>> data;
+	try {
+		data = iop.memoryRead (ranges, window);
+	}
+	catch (HIDPP20::Error &e) {
+		if (mem_type != IOnboardProfiles::ROM)
+			throw;
+		// Some ROM sectors may not exist, read them one by one
+		data.clear ();
+		for (const auto &range: ranges) {
+			try {
+				data.push_back (iop.memoryRead (mem_type, range.page, 0, range.length, window));
+			}
+			catch (HIDPP20::Error &e) {
+				Log::debug ("memory").printf ("Skipping ROM sector %u: %s\n", range.page, e.what ());
+				data.emplace_back ();
+			}
+		}
+	}
+	std::vector<MemorySnapshot::Sector> sectors;
+	for (std::size_t i = 0; i < ranges.size (); ++i) {
+		if (data[i].empty ())
+			continue;
+		data[i].resize (desc.sector_size);
+		sectors.push_back ({ mem_type, ranges[i].page, std::move (data[i]) });
+	}
+	return sectors;
+}
+
+MemorySnapshot MemorySnapshot::take (Device *dev, unsigned int window)
+{
+	IOnboardProfiles iop (dev);
+	MemorySnapshot snapshot;
+	snapshot.vendor_id = dev->dispatcher ()->vendorID ();
+	snapshot.product_id = dev->productID ();
+	snapshot.name = dev->name ();
+	snapshot.description = iop.getDescription ();
+	for (auto mem_type: { IOnboardProfiles::Writeable, IOnboardProfiles::ROM }) {
+		auto sectors = readSectors (iop, snapshot.description, mem_type, window);
+		std::move (sectors.begin (), sectors.end (), std::back_inserter (snapshot.sectors));
+	}
+	return snapshot;
+}
+
+bool MemorySnapshot::matches (Device *dev) const
+{
+	auto desc = IOnboardProfiles (dev).getDescription ();
+	return vendor_id == dev->dispatcher ()->vendorID () &&
+		product_id == dev->productID () &&
+		desc.memory_model == description.memory_model &&
+		desc.sector_count == description.sector_count &&
+		desc.sector_size == description.sector_size;
+}
+
+unsigned int MemorySnapshot::restore (Device *dev, unsigned int window, bool verify) const
+{
+	// The image already contains the CRCs
+	MemoryMapping mem (dev, false);
+	mem.setReadWindow (window);
+	std::vector<Address> addresses;
+	for (const auto &sector: sectors)
+		if (sector.mem_type == IOnboardProfiles::Writeable)
+			addresses.push_back ({ sector.mem_type, sector.page, 0 });
+	mem.prefetch (addresses);
+
+	unsigned int written = 0;
+	for (const auto &sector: sectors) {
+		if (sector.mem_type != IOnboardProfiles::Writeable)
+			continue;
+		Address address = { sector.mem_type, sector.page, 0 };
+		if (mem.getReadOnlyPage (address) == sector.data)
+			continue;
+		auto &page = mem.getWritablePage (address);
+		if (page.size () != sector.data.size ())
+			throw std::runtime_error ("Sector size does not match the device");
+		page = sector.data;
+		++written;
+	}
+	if (verify)
+		mem.syncVerified ();
+	else
+		mem.sync ();
+	return written;
+}
+
+static void pushDescription (std::vector<uint8_t> &buffer, const IOnboardProfiles::Description &desc)
+{
+	buffer.push_back (desc.memory_model);
+	buffer.push_back (desc.profile_format);
+	buffer.push_back (desc.macro_format);
+	buffer.push_back (desc.profile_count);
+	buffer.push_back (desc.profile_count_oob);
+	buffer.push_back (desc.button_count);
+	buffer.push_back (desc.sector_count);
+	pushBE<uint16_t> (buffer, desc.sector_size);
+	buffer.push_back (desc.mechanical_layout);
+	buffer.push_back (desc.various_info);
+}
+
+static constexpr std::size_t DescriptionLength = 11;
+
+void MemorySnapshot::save (std::ostream &stream) const
+{
+	std::vector<uint8_t> buffer (Magic, Magic + sizeof (Magic));
+	pushBE<uint16_t> (buffer, FormatVersion);
+	pushBE<uint16_t> (buffer, vendor_id);
+	pushBE<uint16_t> (buffer, product_id);
+	if (name.size () > 255)
+		throw std::logic_error ("device name too long");
+	buffer.push_back (name.size ());
+	buffer.insert (buffer.end (), name.begin (), name.end ());
+	pushDescription (buffer, description);
+	pushBE<uint16_t> (buffer, sectors.size ());
+	pushBE<uint16_t> (buffer, CRC::CCITT (buffer.begin (), buffer.end ()));
+
+	for (const auto &sector: sectors) {
+		buffer.push_back (sector.mem_type);
+		pushBE<uint16_t> (buffer, sector.page);
+		pushBE<uint16_t> (buffer, sector.data.size ());
+		pushBE<uint16_t> (buffer, CRC::CCITT (sector.data.begin (), sector.data.end ()));
+		buffer.insert (buffer.end (), sector.data.begin (), sector.data.end ());
+	}
+	stream.write (reinterpret_cast<const char *> (buffer.data ()), buffer.size ());
+	if (!stream)
+		throw std::runtime_error ("Failed to write memory image");
+}
+
+namespace
+{
+
+class ImageReader
+{
+public:
+	ImageReader (std::istream &stream):
+		_stream (stream)
+	{
+	}
+
+	std::vector<uint8_t> read (std::size_t length)
+	{
+		std::vector<uint8_t> data (length);
+		_stream.read (reinterpret_cast<char *> (data.data ()), length);
+		if (_stream.gcount () != static_cast<std::streamsize> (length))
+			throw std::runtime_error ("Truncated memory image");
+		_header.insert (_header.end (), data.begin (), data.end ());
+		return data;
+	}
+
+	template<typename T>
+	T read ()
+	{
+		return readBE<T> (read (sizeof (T)), 0);
+	}
+
+	/**
+	 * Bytes read since the last call
+	 */
+	std::vector<uint8_t> consumed ()
+	{
+		return std::move (_header);
+	}
+
+private:
+	std::istream &_stream;
+	std::vector<uint8_t> _header;
+};
+
+}
+
+MemorySnapshot MemorySnapshot::load (std::istream &stream)
+{
+	ImageReader reader (stream);
+	auto magic = reader.read (sizeof (Magic));
+	if (!std::equal (magic.begin (), magic.end (), Magic))
+		throw std::runtime_error ("Not a memory image");
+	if (reader.read<uint16_t> () != FormatVersion)
+		throw std::runtime_error ("Unsupported memory image version");
+
+	MemorySnapshot snapshot;
+	snapshot.vendor_id = reader.read<uint16_t> ();
+	snapshot.product_id = reader.read<uint16_t> ();
+	auto name = reader.read (reader.read<uint8_t> ());
+	snapshot.name.assign (name.begin (), name.end ());
+	auto desc = reader.read (DescriptionLength);
+	snapshot.description = {
+		desc[0], desc[1], desc[2], desc[3], desc[4], desc[5], desc[6],
+		readBE<uint16_t> (desc, 7), desc[9], desc[10]
+	};
+	unsigned int sector_count = reader.read<uint16_t> ();
+	auto header = reader.consumed ();
+	if (reader.read<uint16_t> () != CRC::CCITT (header.begin (), header.end ()))
+		throw std::runtime_error ("Memory image header is corrupted");
+
+	for (unsigned int i = 0; i < sector_count; ++i) {
+		Sector sector;
+		sector.mem_type = static_cast<IOnboardProfiles::MemoryType> (reader.read<uint8_t> ());
+		sector.page = reader.read<uint16_t> ();
+		std::size_t length = reader.read<uint16_t> ();
+		uint16_t crc = reader.read<uint16_t> ();
+		sector.data = reader.read (length);
+		if (crc != CRC::CCITT (sector.data.begin (), sector.data.end ()))
+			throw std::runtime_error ("Memory image sector is corrupted");
+		reader.consumed ();
+		snapshot.sectors.push_back (std::move (sector));
+	}
+	return snapshot;
+}
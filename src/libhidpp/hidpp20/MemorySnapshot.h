@@ -0,0 +1,103 @@
+/*
+ * Copyright 2026 Clément Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef LIBHIDPP_HIDPP20_MEMORY_SNAPSHOT_H
+#define LIBHIDPP_HIDPP20_MEMORY_SNAPSHOT_H
+
+#include <hidpp20/IOnboardProfiles.h>
+#include <hidpp/AbstractMemoryMapping.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace HIDPP20
+{
+
+class Device;
+
+/**
+ * Image of the whole onboard memory of a device.
+ *
+ * The image file starts with a header ("HPMS" magic, format version,
+ * device identity and onboard profiles description) followed by the
+ * sectors, each with its memory type, page, size and CRC-CCITT. All
+ * integers are big endian. The header is also protected by a CRC.
+ */
+struct MemorySnapshot
+{
+	static constexpr uint16_t FormatVersion = 1;
+
+	uint16_t vendor_id;
+	uint16_t product_id;
+	std::string name;
+	IOnboardProfiles::Description description;
+
+	struct Sector
+	{
+		IOnboardProfiles::MemoryType mem_type;
+		unsigned int page;
+		std::vector<uint8_t> data;
+	};
+	std::vector<Sector> sectors;
+
+	/**
+	 * Read every writeable and ROM sector of \p dev.
+	 *
+	 * Each memory type is read in a single pipeline keeping up to
+	 * \p window requests in flight. ROM sectors that the device refuses
+	 * to read are skipped.
+	 */
+	static MemorySnapshot take (Device *dev,
+				    unsigned int window = HIDPP::AbstractMemoryMapping::DefaultReadWindow);
+
+	/**
+	 * Check that the snapshot was taken from the same model of device
+	 * with the same memory layout as \p dev.
+	 */
+	bool matches (Device *dev) const;
+
+	/**
+	 * Write the writeable sectors back to \p dev.
+	 *
+	 * The current memory is read first and only the lines that differ
+	 * are written. With \p verify, they are checked with
+	 * HIDPP::AbstractMemoryMapping::syncVerified. ROM sectors are ignored.
+	 *
+	 * \returns the number of sectors that were written.
+	 */
+	unsigned int restore (Device *dev,
+			      unsigned int window = HIDPP::AbstractMemoryMapping::DefaultReadWindow,
+			      bool verify = false) const;
+
+	/**
+	 * Write the image to \p stream.
+	 */
+	void save (std::ostream &stream) const;
+	/**
+	 * Read an image from \p stream.
+	 *
+	 * \throws std::runtime_error if the image is invalid or corrupted.
+	 */
+	static MemorySnapshot load (std::istream &stream);
+};
+
+}
+
+#endif
@@ -23,7 +23,7 @@
 using namespace HIDPP;
 using namespace HIDPP20;
 
-const std::map<std::string, HIDPP::SettingDesc> &ProfileDirectoryFormat::settings () const
+SettingSchema ProfileDirectoryFormat::settings () const
 {
 	return Settings;
 }
@@ -39,8 +39,8 @@ ProfileDirectory ProfileDirectoryFormat::read (std::vector<uint8_t>::const_itera
 		dir.entries.emplace_back ();
 		auto &entry = dir.entries.back ();
 		entry.profile_address = {mem_type, page, 0},
-		entry.settings.emplace ("enabled", static_cast<bool> (begin[2]));
-		entry.settings.emplace ("dir_unknown", static_cast<int> (begin[3]));
+		entry.settings.set (EntrySetting::Enabled, static_cast<bool> (begin[2]));
+		entry.settings.set (EntrySetting::Unknown, static_cast<int> (begin[3]));
 		begin += 4;
 	}
 	return dir;
@@ -52,14 +52,14 @@ void ProfileDirectoryFormat::write (const ProfileDirectory &profile_directory, s
 		SettingLookup settings (entry.settings, Settings);
 		begin[0] = entry.profile_address.mem_type;
 		begin[1] = entry.profile_address.page;
-		begin[2] = (settings.get<bool> ("enabled") ? 0x01 : 0x00);
-		begin[3] = settings.get<int> ("dir_unknown");
+		begin[2] = (settings.get<bool> (EntrySetting::Enabled) ? 0x01 : 0x00);
+		begin[3] = settings.get<int> (EntrySetting::Unknown);
 		begin += 4;
 	}
 	begin[0] = begin[1] = 0xff;
 }
 
-const std::map<std::string, SettingDesc> ProfileDirectoryFormat::Settings = {
+const SettingSchema::Entry ProfileDirectoryFormat::Settings[] = {
 	{ "enabled", SettingDesc (true) },
 	{ "dir_unknown", SettingDesc (0, 255, 0) },
 };
@@ -28,13 +28,23 @@ namespace HIDPP20
 class ProfileDirectoryFormat: public HIDPP::AbstractProfileDirectoryFormat
 {
 public:
-	virtual const std::map<std::string, HIDPP::SettingDesc> &settings () const;
+	struct EntrySetting
+	{
+		enum: std::size_t
+		{
+			Enabled,
+			Unknown,
+			Count
+		};
+	};
+
+	virtual HIDPP::SettingSchema settings () const;
 
 	virtual HIDPP::ProfileDirectory read (std::vector<uint8_t>::const_iterator begin) const;
 	virtual void write (const HIDPP::ProfileDirectory &profile_directory, std::vector<uint8_t>::iterator begin) const;
 
 private:
-	static const std::map<std::string, HIDPP::SettingDesc> Settings;
+	static const HIDPP::SettingSchema::Entry Settings[EntrySetting::Count];
 };
 
 class Device;
@@ -25,6 +25,7 @@
 
 #include <codecvt>
 #include <cassert>
+#include <stdexcept>
 
 using namespace HIDPP;
 using namespace HIDPP20;
@@ -107,7 +108,7 @@ ProfileFormat::ProfileFormat (const IOnboardProfiles::Description &desc):
 	AbstractProfileFormat (ProfileLength.at (desc.profile_format),
 			       desc.button_count, MaxModeCount),
 	_desc (desc),
-	_general_settings (CommonGeneralSettings),
+	_general_settings (GeneralSettings),
 	_has_g_shift ((_desc.mechanical_layout & 0x03) == 2),
 	_has_dpi_shift ((_desc.mechanical_layout & 0x0c) >> 2 == 2),
 	_has_rgb_effects (_desc.profile_format >= 2),
@@ -115,24 +116,25 @@ ProfileFormat::ProfileFormat (const IOnboardProfiles::Description &desc):
 {
 	assert (_desc.button_count <= MaxButtonCount);
 	// TODO: check profile format in desc
-	if (_has_rgb_effects) {
-		_general_settings.emplace ("logo_effect", RGBEffectSettings);
-		_general_settings.emplace ("side_effect", RGBEffectSettings);
+	if (!_has_rgb_effects) {
+		_general_settings = _general_settings
+			.without (GeneralSetting::LogoEffect)
+			.without (GeneralSetting::SideEffect);
 	}
-	if (_has_dpi_shift) {
-		_general_settings.emplace ("switched_dpi", SettingDesc (0, MaxModeCount-1, 0));
+	if (!_has_dpi_shift) {
+		_general_settings = _general_settings.without (GeneralSetting::SwitchedDPI);
 	}
-	if (_has_power_modes) {
-		_general_settings.emplace ("power_mode", SettingDesc (PowerModes, -1));
+	if (!_has_power_modes) {
+		_general_settings = _general_settings.without (GeneralSetting::PowerMode);
 	}
 }
 
-const std::map<std::string, SettingDesc> &ProfileFormat::generalSettings () const
+SettingSchema ProfileFormat::generalSettings () const
 {
 	return _general_settings;
 }
 
-const std::map<std::string, SettingDesc> &ProfileFormat::modeSettings () const
+SettingSchema ProfileFormat::modeSettings () const
 {
 	return ModeSettings;
 }
@@ -226,23 +228,23 @@ ComposedSetting ProfileFormat::readRGBEffect (std::vector<uint8_t>::const_iterat
 	case RGBEffectOff:
 		break;
 	case RGBEffectConstant:
-		settings.emplace ("color", ConstantColor.read (begin));
+		settings.set (RGBEffectSetting::Color, ConstantColor.read (begin));
 		break;
 	case RGBEffectPulse:
-		settings.emplace ("color", PulseColor.read (begin));
-		settings.emplace ("period", static_cast<int> (PulsePeriod.read (begin)));
-		settings.emplace ("brightness", static_cast<int> (PulseBrightness.read (begin)));
+		settings.set (RGBEffectSetting::Color, PulseColor.read (begin));
+		settings.set (RGBEffectSetting::Period, static_cast<int> (PulsePeriod.read (begin)));
+		settings.set (RGBEffectSetting::Brightness, static_cast<int> (PulseBrightness.read (begin)));
 		break;
 	case RGBEffectCycle:
-		settings.emplace ("period", static_cast<int> (CyclePeriod.read (begin)));
-		settings.emplace ("brightness", static_cast<int> (CycleBrightness.read (begin)));
+		settings.set (RGBEffectSetting::Period, static_cast<int> (CyclePeriod.read (begin)));
+		settings.set (RGBEffectSetting::Brightness, static_cast<int> (CycleBrightness.read (begin)));
 		break;
 	default:
 		Log::error () << "Invalid LED effect type" << std::endl;
 		Log::debug ().printBytes ("LED Effect", begin, begin+11);
 		return settings;
 	}
-	settings.emplace ("type", EnumValue (ProfileFormat::RGBEffects, type));
+	settings.set (RGBEffectSetting::Type, EnumValue (ProfileFormat::RGBEffects, type));
 	return settings;
 }
 
@@ -250,23 +252,23 @@ void ProfileFormat::writeRGBEffect (std::vector<uint8_t>::iterator begin, const
 {
 	using namespace Fields::RGBEffect;
 	std::fill (begin, begin+11, 0);
-	SettingLookup effect (settings, RGBEffectSettings);
-	int type = effect.get<EnumValue> ("type").get ();
+	SettingLookup effect (settings, RGBEffectSchema);
+	int type = effect.get<EnumValue> (RGBEffectSetting::Type).get ();
 	Type.write (begin, type);
 	switch (type) {
 	case RGBEffectOff:
 		break;
 	case RGBEffectConstant:
-		ConstantColor.write (begin, effect.get<Color> ("color"));
+		ConstantColor.write (begin, effect.get<Color> (RGBEffectSetting::Color));
 		break;
 	case RGBEffectPulse:
-		PulseColor.write (begin, effect.get<Color> ("color"));
-		PulsePeriod.write (begin, effect.get<int> ("period"));
-		PulseBrightness.write (begin, effect.get<int> ("brightness"));
+		PulseColor.write (begin, effect.get<Color> (RGBEffectSetting::Color));
+		PulsePeriod.write (begin, effect.get<int> (RGBEffectSetting::Period));
+		PulseBrightness.write (begin, effect.get<int> (RGBEffectSetting::Brightness));
 		break;
 	case RGBEffectCycle:
-		CyclePeriod.write (begin, effect.get<int> ("period"));
-		CycleBrightness.write (begin, effect.get<int> ("brightness"));
+		CyclePeriod.write (begin, effect.get<int> (RGBEffectSetting::Period));
+		CycleBrightness.write (begin, effect.get<int> (RGBEffectSetting::Brightness));
 		break;
 	}
 }
@@ -280,24 +282,24 @@ Profile ProfileFormat::read (std::vector<uint8_t>::const_iterator begin) const
 	// TODO: missing settings
 	// TODO: add settings depending on desc
 	Profile profile;
-	profile.settings.emplace ("report_rate", static_cast<int> (ReportRate.read (begin)));
-	profile.settings.emplace ("default_dpi", static_cast<int> (DefaultDPI.read (begin)));
-	profile.settings.emplace ("switched_dpi", static_cast<int> (SwitchedDPI.read (begin)));
+	profile.settings.set (GeneralSetting::ReportRate, static_cast<int> (ReportRate.read (begin)));
+	profile.settings.set (GeneralSetting::DefaultDPI, static_cast<int> (DefaultDPI.read (begin)));
+	if (_has_dpi_shift)
+		profile.settings.set (GeneralSetting::SwitchedDPI, static_cast<int> (SwitchedDPI.read (begin)));
 	for (unsigned int i = 0; i < MaxModeCount; ++i) {
 		uint16_t dpi = Modes.read (begin, i);
 		if (dpi == 0x0000 || dpi == 0xFFFF)
 			break;
-		profile.modes.push_back ({
-			{ "dpi", static_cast<int> (dpi) },
-		});
+		profile.modes.emplace_back (ModeSetting::Count);
+		profile.modes.back ().set (ModeSetting::DPI, static_cast<int> (dpi));
 	}
-	profile.settings.emplace ("color", ProfileColor.read (begin));
+	profile.settings.set (GeneralSetting::Color, ProfileColor.read (begin));
 	if (_has_power_modes) {
-		profile.settings.emplace ("power_mode",
-					  EnumValue (PowerModes, PowerMode.read (begin)));
+		profile.settings.set (GeneralSetting::PowerMode,
+				      EnumValue (PowerModes, PowerMode.read (begin)));
 	}
-	profile.settings.emplace ("angle_snapping", AngleSnapping.read (begin) != 0);
-	profile.settings.emplace ("revision", static_cast<int> (Revision.read (begin)));
+	profile.settings.set (GeneralSetting::AngleSnapping, AngleSnapping.read (begin) != 0);
+	profile.settings.set (GeneralSetting::Revision, static_cast<int> (Revision.read (begin)));
 	for (unsigned int i = 0; i < (_has_g_shift ? 2 : 1); ++i) { // Normal/alternate buttons
 		for (unsigned int j = 0; j < _desc.button_count; ++j) {
 			auto button_data = Buttons.begin (begin, i*MaxButtonCount + j);
@@ -316,13 +318,13 @@ Profile ProfileFormat::read (std::vector<uint8_t>::const_iterator begin) const
 		catch (std::exception &e) {
 			Log::warning() << "Failed to convert profile name." << std::endl;
 		}
-		profile.settings.emplace ("name", name);
+		profile.settings.set (GeneralSetting::Name, name);
 	}
 	if (_has_rgb_effects) {
-		profile.settings.emplace ("logo_effect",
-					  readRGBEffect (LogoEffect.begin (begin)));
-		profile.settings.emplace ("side_effect",
-					  readRGBEffect (SideEffect.begin (begin)));
+		profile.settings.set (GeneralSetting::LogoEffect,
+				      readRGBEffect (LogoEffect.begin (begin)));
+		profile.settings.set (GeneralSetting::SideEffect,
+				      readRGBEffect (SideEffect.begin (begin)));
 	}
 	return profile;
 }
@@ -332,13 +334,13 @@ void ProfileFormat::write (const Profile &profile, std::vector<uint8_t>::iterato
 	using namespace Fields;
 	std::fill (begin, begin + ProfileLength.at (_desc.profile_format), 0xff);
 	SettingLookup general (profile.settings, _general_settings);
-	ReportRate.write (begin, general.get<int> ("report_rate"));
-	DefaultDPI.write (begin, general.get<int> ("default_dpi"));
-	SwitchedDPI.write (begin, general.get<int> ("switched_dpi"));
+	ReportRate.write (begin, general.get<int> (GeneralSetting::ReportRate));
+	DefaultDPI.write (begin, general.get<int> (GeneralSetting::DefaultDPI));
+	SwitchedDPI.write (begin, general.get<int> (GeneralSetting::SwitchedDPI));
 	for (unsigned int i = 0; i < MaxModeCount; ++i) {
 		if (i < profile.modes.size ()) {
 			SettingLookup mode (profile.modes[i], ModeSettings);
-			Modes.write (begin, i, mode.get<int> ("dpi"));
+			Modes.write (begin, i, mode.get<int> (ModeSetting::DPI));
 		}
 		else {
 			// Write 0 after for disabled modes.
@@ -346,11 +348,11 @@ void ProfileFormat::write (const Profile &profile, std::vector<uint8_t>::iterato
 			Modes.write (begin, i, 0);
 		}
 	}
-	ProfileColor.write (begin, general.get<Color> ("color"));
+	ProfileColor.write (begin, general.get<Color> (GeneralSetting::Color));
 	if (_has_power_modes)
-		PowerMode.write (begin, general.get<EnumValue> ("power_mode").get ());
-	AngleSnapping.write (begin, general.get<bool> ("angle_snapping") ? 0x01 : 0x00);
-	Revision.write (begin, general.get<int> ("revision"));
+		PowerMode.write (begin, general.get<EnumValue> (GeneralSetting::PowerMode).get ());
+	AngleSnapping.write (begin, general.get<bool> (GeneralSetting::AngleSnapping) ? 0x01 : 0x00);
+	Revision.write (begin, general.get<int> (GeneralSetting::Revision));
 	for (unsigned int i = 0; i < (_has_g_shift ? 2 : 1); ++i) { // Normal/alternate buttons
 		for (unsigned int j = 0; j < _desc.button_count; ++j) {
 			auto button_data = Buttons.begin (begin, MaxButtonCount*i + j);
@@ -359,16 +361,153 @@ void ProfileFormat::write (const Profile &profile, std::vector<uint8_t>::iterato
 		}
 	}
 	std::wstring_convert<std::codecvt_utf8_utf16<char16_t>, char16_t> conv16;
-	std::u16string name = conv16.from_bytes (general.get<std::string> ("name"));
+	std::u16string name = conv16.from_bytes (general.get<std::string> (GeneralSetting::Name));
 	name.resize (24, 0);
 	for (int i = 0; i < 24; ++i)
 		Name.write (begin, i, name[i]);
 	if (_has_rgb_effects) {
 		writeRGBEffect (LogoEffect.begin (begin),
-				general.get<ComposedSetting> ("logo_effect"));
+				general.get<ComposedSetting> (GeneralSetting::LogoEffect));
 		writeRGBEffect (SideEffect.begin (begin),
-				general.get<ComposedSetting> ("side_effect"));
+				general.get<ComposedSetting> (GeneralSetting::SideEffect));
+	}
+}
+
+ProfileFormat::ConstView::ConstView (const ProfileFormat &format, std::vector<uint8_t>::const_iterator begin):
+	_format (format),
+	_begin (begin)
+{
+}
+
+int ProfileFormat::ConstView::reportRate () const
+{
+	return Fields::ReportRate.read (_begin);
+}
+
+int ProfileFormat::ConstView::defaultDPI () const
+{
+	return Fields::DefaultDPI.read (_begin);
+}
+
+int ProfileFormat::ConstView::switchedDPI () const
+{
+	return Fields::SwitchedDPI.read (_begin);
+}
+
+unsigned int ProfileFormat::ConstView::modeCount () const
+{
+	unsigned int count = 0;
+	while (count < MaxModeCount) {
+		uint16_t dpi = Fields::Modes.read (_begin, count);
+		if (dpi == 0x0000 || dpi == 0xFFFF)
+			break;
+		++count;
 	}
+	return count;
+}
+
+int ProfileFormat::ConstView::dpi (unsigned int mode) const
+{
+	if (mode >= MaxModeCount)
+		throw std::out_of_range ("mode index");
+	return Fields::Modes.read (_begin, mode);
+}
+
+Color ProfileFormat::ConstView::color () const
+{
+	return Fields::ProfileColor.read (_begin);
+}
+
+int ProfileFormat::ConstView::powerMode () const
+{
+	return Fields::PowerMode.read (_begin);
+}
+
+bool ProfileFormat::ConstView::angleSnapping () const
+{
+	return Fields::AngleSnapping.read (_begin) != 0;
+}
+
+int ProfileFormat::ConstView::revision () const
+{
+	return Fields::Revision.read (_begin);
+}
+
+unsigned int ProfileFormat::ConstView::buttonSlot (unsigned int index) const
+{
+	unsigned int button_count = _format._desc.button_count;
+	if (index >= button_count * (_format._has_g_shift ? 2 : 1))
+		throw std::out_of_range ("button index");
+	return (index / button_count) * MaxButtonCount + index % button_count;
+}
+
+Profile::Button ProfileFormat::ConstView::button (unsigned int index) const
+{
+	return readButton (Fields::Buttons.begin (_begin, buttonSlot (index)));
+}
+
+ProfileFormat::View::View (const ProfileFormat &format, std::vector<uint8_t>::iterator begin):
+	ConstView (format, begin),
+	_wbegin (begin)
+{
+}
+
+void ProfileFormat::View::setReportRate (int report_rate) const
+{
+	Fields::ReportRate.write (_wbegin, report_rate);
+}
+
+void ProfileFormat::View::setDefaultDPI (int index) const
+{
+	Fields::DefaultDPI.write (_wbegin, index);
+}
+
+void ProfileFormat::View::setSwitchedDPI (int index) const
+{
+	Fields::SwitchedDPI.write (_wbegin, index);
+}
+
+void ProfileFormat::View::setDPI (unsigned int mode, int dpi) const
+{
+	if (mode >= MaxModeCount)
+		throw std::out_of_range ("mode index");
+	Fields::Modes.write (_wbegin, mode, dpi);
+}
+
+void ProfileFormat::View::setColor (Color color) const
+{
+	Fields::ProfileColor.write (_wbegin, color);
+}
+
+void ProfileFormat::View::setPowerMode (int power_mode) const
+{
+	if (_format._has_power_modes)
+		Fields::PowerMode.write (_wbegin, power_mode);
+}
+
+void ProfileFormat::View::setAngleSnapping (bool angle_snapping) const
+{
+	Fields::AngleSnapping.write (_wbegin, angle_snapping ? 0x01 : 0x00);
+}
+
+void ProfileFormat::View::setRevision (int revision) const
+{
+	Fields::Revision.write (_wbegin, revision);
+}
+
+void ProfileFormat::View::setButton (unsigned int index, const Profile::Button &button) const
+{
+	writeButton (Fields::Buttons.begin (_wbegin, buttonSlot (index)), button);
+}
+
+ProfileFormat::ConstView ProfileFormat::view (std::vector<uint8_t>::const_iterator begin) const
+{
+	return ConstView (*this, begin);
+}
+
+ProfileFormat::View ProfileFormat::view (std::vector<uint8_t>::iterator begin) const
+{
+	return View (*this, begin);
 }
 
 const std::map<uint8_t, size_t> ProfileFormat::ProfileLength = {
@@ -377,23 +516,29 @@ const std::map<uint8_t, size_t> ProfileFormat::ProfileLength = {
 	{ 3, 230 },
 };
 
-const std::map<std::string, SettingDesc> ProfileFormat::RGBEffectSettings = {
+const SettingSchema::Entry ProfileFormat::RGBEffectSettings[] = {
 	{ "type", SettingDesc (RGBEffects, RGBEffectConstant) },
 	{ "color", SettingDesc (Color { 255, 255, 255 }) },
 	{ "period", SettingDesc (0, 65535, 10000) },
 	{ "brightness", SettingDesc (0, 100, 100) },
 };
 
-const std::map<std::string, SettingDesc> ProfileFormat::CommonGeneralSettings = {
+const SettingSchema ProfileFormat::RGBEffectSchema (RGBEffectSettings);
+
+const SettingSchema::Entry ProfileFormat::GeneralSettings[] = {
 	{ "report_rate", SettingDesc (1, 8, 4) },
 	{ "default_dpi", SettingDesc (0, MaxModeCount-1, 0) },
 	{ "color", SettingDesc (Color { 255, 255, 255 }) }, // Unused on G502 (profile format 2)
 	{ "angle_snapping", SettingDesc (false) },
 	{ "revision", SettingDesc (0, 65535, 65535) },
-	{ "name", SettingDesc (std::string ("profile name")) },
+	{ "name", SettingDesc ("profile name") },
+	{ "logo_effect", SettingDesc (RGBEffectSchema) },
+	{ "side_effect", SettingDesc (RGBEffectSchema) },
+	{ "switched_dpi", SettingDesc (0, MaxModeCount-1, 0) },
+	{ "power_mode", SettingDesc (PowerModes, -1) },
 };
 
-const std::map<std::string, SettingDesc> ProfileFormat::ModeSettings = {
+const SettingSchema::Entry ProfileFormat::ModeSettings[] = {
 	{ "dpi", SettingDesc (0, 50000, 1200) }, // TODO: Get proper values from AdjustableDPI
 };
 
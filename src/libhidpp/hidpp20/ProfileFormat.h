@@ -32,16 +32,135 @@ class ProfileFormat: public HIDPP::AbstractProfileFormat
 public:
 	ProfileFormat (const IOnboardProfiles::Description &desc);
 
-	virtual const std::map<std::string, HIDPP::SettingDesc> &generalSettings () const;
-	virtual const std::map<std::string, HIDPP::SettingDesc> &modeSettings () const;
+	/**
+	 * Indexes of the general settings.
+	 *
+	 * Logo and side effects, switched DPI and power mode are not available
+	 * on every device.
+	 */
+	struct GeneralSetting
+	{
+		enum: std::size_t
+		{
+			ReportRate,
+			DefaultDPI,
+			Color,
+			AngleSnapping,
+			Revision,
+			Name,
+			LogoEffect,
+			SideEffect,
+			SwitchedDPI,
+			PowerMode,
+			Count
+		};
+	};
+	struct ModeSetting
+	{
+		enum: std::size_t
+		{
+			DPI,
+			Count
+		};
+	};
+	/**
+	 * Indexes of the sub-settings of LogoEffect and SideEffect.
+	 */
+	struct RGBEffectSetting
+	{
+		enum: std::size_t
+		{
+			Type,
+			Color,
+			Period,
+			Brightness,
+			Count
+		};
+	};
+
+	virtual HIDPP::SettingSchema generalSettings () const;
+	virtual HIDPP::SettingSchema modeSettings () const;
 	virtual const HIDPP::EnumDesc &specialActions () const;
 
 	virtual HIDPP::Profile read (std::vector<uint8_t>::const_iterator begin) const;
 	virtual void write (const HIDPP::Profile &profile, std::vector<uint8_t>::iterator begin) const;
 
+	/**
+	 * Read-only access to the fields of the profile beginning at \p begin
+	 * without decoding the whole profile.
+	 *
+	 * The view does not copy the profile, the memory must stay valid and
+	 * unmoved while it is used. Name and RGB effects are only available
+	 * through read.
+	 */
+	class ConstView
+	{
+	public:
+		ConstView (const ProfileFormat &format, std::vector<uint8_t>::const_iterator begin);
+
+		int reportRate () const;
+		int defaultDPI () const;
+		int switchedDPI () const;
+		/**
+		 * Number of enabled modes.
+		 */
+		unsigned int modeCount () const;
+		int dpi (unsigned int mode) const;
+		HIDPP::Color color () const;
+		int powerMode () const;
+		bool angleSnapping () const;
+		int revision () const;
+		/**
+		 * Button \p index, using the same order as Profile::buttons.
+		 */
+		HIDPP::Profile::Button button (unsigned int index) const;
+
+	protected:
+		const ProfileFormat &_format;
+		std::vector<uint8_t>::const_iterator _begin;
+
+		unsigned int buttonSlot (unsigned int index) const;
+	};
+
+	/**
+	 * Same as ConstView but also modifies the fields in place.
+	 *
+	 * Values are not checked against the setting descriptions.
+	 */
+	class View: public ConstView
+	{
+	public:
+		View (const ProfileFormat &format, std::vector<uint8_t>::iterator begin);
+
+		void setReportRate (int report_rate) const;
+		void setDefaultDPI (int index) const;
+		void setSwitchedDPI (int index) const;
+		/**
+		 * Enabled modes end at the first resolution equal to 0 or 0xffff
+		 * (see modeCount), so setting a valid resolution only enables a
+		 * disabled mode if every mode before it is enabled.
+		 */
+		void setDPI (unsigned int mode, int dpi) const;
+		void setColor (HIDPP::Color color) const;
+		/**
+		 * Does nothing if the device has no power modes, write() skips
+		 * the field too.
+		 */
+		void setPowerMode (int power_mode) const;
+		void setAngleSnapping (bool angle_snapping) const;
+		void setRevision (int revision) const;
+		void setButton (unsigned int index, const HIDPP::Profile::Button &button) const;
+
+	private:
+		std::vector<uint8_t>::iterator _wbegin;
+	};
+
+	ConstView view (std::vector<uint8_t>::const_iterator begin) const;
+	View view (std::vector<uint8_t>::iterator begin) const;
+
 private:
 	IOnboardProfiles::Description _desc;
-	std::map<std::string, HIDPP::SettingDesc> _general_settings;
+	HIDPP::SettingSchema _general_settings;
 	bool _has_g_shift;
 	bool _has_dpi_shift;
 	bool _has_rgb_effects;
@@ -54,9 +173,10 @@ private:
 	static constexpr unsigned int MaxButtonCount = 16;
 	static constexpr unsigned int MaxModeCount = 5;
 
-	static const std::map<std::string, HIDPP::SettingDesc> RGBEffectSettings;
-	static const std::map<std::string, HIDPP::SettingDesc> CommonGeneralSettings;
-	static const std::map<std::string, HIDPP::SettingDesc> ModeSettings;
+	static const HIDPP::SettingSchema::Entry RGBEffectSettings[RGBEffectSetting::Count];
+	static const HIDPP::SettingSchema RGBEffectSchema;
+	static const HIDPP::SettingSchema::Entry GeneralSettings[GeneralSetting::Count];
+	static const HIDPP::SettingSchema::Entry ModeSettings[ModeSetting::Count];
 	static const HIDPP::EnumDesc SpecialActions;
 	static const HIDPP::EnumDesc RGBEffects;
 	static const HIDPP::EnumDesc PowerModes;
@@ -18,9 +18,21 @@
 
 #include <misc/CRC.h>
 
-uint16_t CRC::CCITT (std::vector<uint8_t>::const_iterator begin,
-		     std::vector<uint8_t>::const_iterator end,
-		     uint16_t start_value)
+#include <array>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CRC_CLMUL_X86
+#include <immintrin.h>
+#elif defined(__aarch64__) && (defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_AES))
+#define CRC_PMULL_ARM
+#include <arm_neon.h>
+#endif
+
+static constexpr uint16_t Polynomial = 0x1021;
+
+uint16_t CRC::CCITTReference (const uint8_t *begin, const uint8_t *end,
+			      uint16_t start_value)
 {
 	uint16_t crc = start_value;
 
@@ -38,3 +50,207 @@ uint16_t CRC::CCITT (std::vector<uint8_t>::const_iterator begin,
 	return crc;
 }
 
+/*
+ * tables[k][b] is the CRC register contribution of byte b followed by k
+ * null bytes.
+ */
+static constexpr std::array<std::array<uint16_t, 256>, 8> makeTables ()
+{
+	std::array<std::array<uint16_t, 256>, 8> tables = {};
+	for (unsigned int b = 0; b < 256; ++b) {
+		uint16_t crc = b << 8;
+		for (int i = 0; i < 8; ++i)
+			crc = (crc & 0x8000 ? (crc << 1) ^ Polynomial : crc << 1);
+		tables[0][b] = crc;
+	}
+	for (unsigned int k = 1; k < 8; ++k)
+		for (unsigned int b = 0; b < 256; ++b) {
+			uint16_t prev = tables[k-1][b];
+			tables[k][b] = (prev << 8) ^ tables[0][prev >> 8];
+		}
+	return tables;
+}
+
+static constexpr auto Tables = makeTables ();
+
+uint16_t CRC::CCITTSliceBy8 (const uint8_t *begin, const uint8_t *end,
+			     uint16_t start_value)
+{
+	uint16_t crc = start_value;
+	while (end - begin >= 8) {
+		crc = Tables[7][begin[0] ^ (crc >> 8)] ^
+		      Tables[6][begin[1] ^ (crc & 0xff)] ^
+		      Tables[5][begin[2]] ^ Tables[4][begin[3]] ^
+		      Tables[3][begin[4]] ^ Tables[2][begin[5]] ^
+		      Tables[1][begin[6]] ^ Tables[0][begin[7]];
+		begin += 8;
+	}
+	for (; begin != end; ++begin)
+		crc = (crc << 8) ^ Tables[0][*begin ^ (crc >> 8)];
+	return crc;
+}
+
+#if defined(CRC_CLMUL_X86) || defined(CRC_PMULL_ARM)
+/*
+ * Carry-less multiplication implementations fold the message 16 bytes at
+ * a time into a 128 bits remainder congruent to the message modulo the
+ * polynomial: X' = X_hi * (x^192 mod P) + X_lo * (x^128 mod P) + block.
+ * The start value is xored into the first two bytes and the final 128
+ * bits remainder and the tail are reduced with the tables.
+ */
+static constexpr uint64_t xPowMod (unsigned int n)
+{
+	uint32_t r = 1;
+	for (unsigned int i = 0; i < n; ++i) {
+		r <<= 1;
+		if (r & 0x10000)
+			r ^= 0x10000 | Polynomial;
+	}
+	return r;
+}
+
+static constexpr uint64_t K128 = xPowMod (128);
+static constexpr uint64_t K192 = xPowMod (192);
+
+// Folding is only worth it for a few blocks
+static constexpr std::ptrdiff_t CLMulThreshold = 64;
+
+static uint16_t reduceFolded (const uint8_t folded[16],
+			      const uint8_t *begin, const uint8_t *end)
+{
+	uint16_t crc = CRC::CCITTSliceBy8 (folded, folded + 16, 0);
+	return CRC::CCITTSliceBy8 (begin, end, crc);
+}
+#endif
+
+#ifdef CRC_CLMUL_X86
+__attribute__ ((target ("pclmul,ssse3")))
+static uint16_t CCITTCLMul (const uint8_t *begin, const uint8_t *end,
+			    uint16_t start_value)
+{
+	if (end - begin < CLMulThreshold)
+		return CRC::CCITTSliceBy8 (begin, end, start_value);
+
+	// Load 16 bytes as a big endian 128 bits polynomial
+	const __m128i swap = _mm_set_epi8 (0, 1, 2, 3, 4, 5, 6, 7,
+					   8, 9, 10, 11, 12, 13, 14, 15);
+	const __m128i k = _mm_set_epi64x (K192, K128);
+
+	uint8_t first[16];
+	std::memcpy (first, begin, 16);
+	first[0] ^= start_value >> 8;
+	first[1] ^= start_value & 0xff;
+	__m128i x = _mm_shuffle_epi8 (_mm_loadu_si128 (reinterpret_cast<const __m128i *> (first)), swap);
+	begin += 16;
+	while (end - begin >= 16) {
+		__m128i block = _mm_shuffle_epi8 (_mm_loadu_si128 (reinterpret_cast<const __m128i *> (begin)), swap);
+		__m128i hi = _mm_clmulepi64_si128 (x, k, 0x11);
+		__m128i lo = _mm_clmulepi64_si128 (x, k, 0x00);
+		x = _mm_xor_si128 (_mm_xor_si128 (hi, lo), block);
+		begin += 16;
+	}
+	uint8_t folded[16];
+	_mm_storeu_si128 (reinterpret_cast<__m128i *> (folded), _mm_shuffle_epi8 (x, swap));
+	return reduceFolded (folded, begin, end);
+}
+#endif
+
+#ifdef CRC_PMULL_ARM
+static inline uint64_t loadBE64 (const uint8_t *p)
+{
+	uint64_t value = 0;
+	for (int i = 0; i < 8; ++i)
+		value = (value << 8) | p[i];
+	return value;
+}
+
+static inline void storeBE64 (uint8_t *p, uint64_t value)
+{
+	for (int i = 7; i >= 0; --i, value >>= 8)
+		p[i] = value & 0xff;
+}
+
+static uint16_t CCITTCLMul (const uint8_t *begin, const uint8_t *end,
+			    uint16_t start_value)
+{
+	if (end - begin < CLMulThreshold)
+		return CRC::CCITTSliceBy8 (begin, end, start_value);
+
+	uint64_t hi = loadBE64 (begin) ^ (uint64_t (start_value) << 48);
+	uint64_t lo = loadBE64 (begin + 8);
+	begin += 16;
+	while (end - begin >= 16) {
+		uint64x2_t r = veorq_u64 (
+				vreinterpretq_u64_p128 (vmull_p64 (hi, K192)),
+				vreinterpretq_u64_p128 (vmull_p64 (lo, K128)));
+		hi = vgetq_lane_u64 (r, 1) ^ loadBE64 (begin);
+		lo = vgetq_lane_u64 (r, 0) ^ loadBE64 (begin + 8);
+		begin += 16;
+	}
+	uint8_t folded[16];
+	storeBE64 (folded, hi);
+	storeBE64 (folded + 8, lo);
+	return reduceFolded (folded, begin, end);
+}
+#endif
+
+namespace
+{
+
+using CRC::Implementation;
+
+#if defined(CRC_CLMUL_X86)
+bool hasCLMul ()
+{
+	__builtin_cpu_init ();
+	return __builtin_cpu_supports ("pclmul") && __builtin_cpu_supports ("ssse3");
+}
+
+constexpr Implementation CLMul = { "pclmul", &CCITTCLMul };
+#elif defined(CRC_PMULL_ARM)
+bool hasCLMul ()
+{
+	return true;
+}
+
+constexpr Implementation CLMul = { "pmull", &CCITTCLMul };
+#endif
+constexpr Implementation SliceBy8 = { "slice-by-8", &CRC::CCITTSliceBy8 };
+
+const Implementation &selectImplementation ()
+{
+	static const Implementation impl = [] () -> Implementation {
+#if defined(CRC_CLMUL_X86) || defined(CRC_PMULL_ARM)
+		if (hasCLMul ())
+			return CLMul;
+#endif
+		return SliceBy8;
+	} ();
+	return impl;
+}
+
+}
+
+uint16_t CRC::CCITT (const uint8_t *begin, const uint8_t *end,
+		     uint16_t start_value)
+{
+	return selectImplementation ().function (begin, end, start_value);
+}
+
+const char *CRC::implementationName ()
+{
+	return selectImplementation ().name;
+}
+
+std::vector<CRC::Implementation> CRC::implementations ()
+{
+	std::vector<Implementation> impls = {
+		{ "reference", &CRC::CCITTReference },
+		SliceBy8,
+	};
+#if defined(CRC_CLMUL_X86) || defined(CRC_PMULL_ARM)
+	if (hasCLMul ())
+		impls.push_back (CLMul);
+#endif
+	return impls;
+}
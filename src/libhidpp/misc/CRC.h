@@ -25,11 +25,53 @@
 namespace CRC
 {
 
-uint16_t CCITT (std::vector<uint8_t>::const_iterator begin,
-		std::vector<uint8_t>::const_iterator end,
+/**
+ * Compute the CRC-CCITT (polynomial 0x1021) of the bytes in [\p begin, \p end).
+ *
+ * The fastest implementation supported by the CPU is selected at run
+ * time (carry-less multiplication or slice-by-8 tables).
+ */
+uint16_t CCITT (const uint8_t *begin, const uint8_t *end,
 		uint16_t start_value = 0xFFFF);
 
+inline uint16_t CCITT (std::vector<uint8_t>::const_iterator begin,
+		       std::vector<uint8_t>::const_iterator end,
+		       uint16_t start_value = 0xFFFF)
+{
+	if (begin == end)
+		return start_value;
+	return CCITT (&*begin, &*begin + (end - begin), start_value);
 }
 
-#endif
+/**
+ * Bitwise reference implementation, one byte per iteration.
+ */
+uint16_t CCITTReference (const uint8_t *begin, const uint8_t *end,
+			 uint16_t start_value = 0xFFFF);
+
+/**
+ * Table driven implementation, eight bytes per iteration.
+ */
+uint16_t CCITTSliceBy8 (const uint8_t *begin, const uint8_t *end,
+			uint16_t start_value = 0xFFFF);
+
+/**
+ * Name of the implementation used by CCITT.
+ */
+const char *implementationName ();
+
+struct Implementation
+{
+	const char *name;
+	uint16_t (*function) (const uint8_t *begin, const uint8_t *end, uint16_t start_value);
+};
+
+/**
+ * Every implementation supported by the CPU, starting with the
+ * reference, for checking and benchmarking them.
+ */
+std::vector<Implementation> implementations ();
+
+}
 
+#endif
@@ -64,6 +64,64 @@ Option VerboseOption ()
 	);
 }
 
+Option OptimizeMacrosOption (bool &optimize)
+{
+	return Option (
+		'O', "optimize-macros",
+		Option::NoArgument, "",
+		"Rewrite macros with the shortest equivalent items for the device format.",
+		[&optimize] (const char *) -> bool {
+			optimize = true;
+			return true;
+		});
+}
+
+Option VerifyOption (bool &verify)
+{
+	return Option (
+		'V', "verify",
+		Option::NoArgument, "",
+		"Read back the CRC line of every written page and write it again if it does not match.",
+		[&verify] (const char *) -> bool {
+			verify = true;
+			return true;
+		});
+}
+
+Option ReadWindowOption (unsigned int &window)
+{
+	return Option (
+		'R', "read-window",
+		Option::RequiredArgument, "count",
+		"Keep up to count memory read requests in flight (default is 1).",
+		[&window] (const char *optarg) -> bool {
+			char *endptr;
+			window = strtoul (optarg, &endptr, 10);
+			if (*optarg == '\0' || *endptr != '\0' || window == 0) {
+				fprintf (stderr, "Invalid window: %s\n", optarg);
+				return false;
+			}
+			return true;
+		});
+}
+
+Option WriteWindowOption (unsigned int &window)
+{
+	return Option (
+		'W', "write-window",
+		Option::RequiredArgument, "count",
+		"Send up to count memory write packets before waiting for their acknowledgements (default is 1).",
+		[&window] (const char *optarg) -> bool {
+			char *endptr;
+			window = strtoul (optarg, &endptr, 10);
+			if (*optarg == '\0' || *endptr != '\0' || window == 0) {
+				fprintf (stderr, "Invalid window: %s\n", optarg);
+				return false;
+			}
+			return true;
+		});
+}
+
 Option HelpOption (const char *program, const char *args,
 		   const std::vector<Option> *options)
 {
@@ -6,6 +6,10 @@
 
 Option DeviceIndexOption (HIDPP::DeviceIndex &device_index);
 Option VerboseOption ();
+Option OptimizeMacrosOption (bool &optimize);
+Option VerifyOption (bool &verify);
+Option ReadWindowOption (unsigned int &window);
+Option WriteWindowOption (unsigned int &window);
 Option HelpOption (const char *program, const char *args, const std::vector<Option> *options);
 
 #endif
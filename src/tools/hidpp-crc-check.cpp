@@ -0,0 +1,128 @@
+/*
+ * Copyright 2026 Clément Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+#include <misc/CRC.h>
+
+#include "common/common.h"
+#include "common/Option.h"
+#include "common/CommonOptions.h"
+
+static constexpr std::size_t MaxLength = 4096;
+static constexpr std::size_t MaxAlignment = 64;
+
+int main (int argc, char *argv[])
+{
+	static const char *args = "";
+	unsigned int count = 100000;
+	std::size_t bench_length = 512;
+	std::size_t bench_total = 64 << 20;
+
+	std::vector<Option> options = {
+		Option ('n', "count",
+			Option::RequiredArgument, "count",
+			"Number of random buffers checked (default is 100000).",
+			[&count] (const char *optarg) -> bool {
+				char *endptr;
+				count = strtoul (optarg, &endptr, 10);
+				return *optarg != '\0' && *endptr == '\0';
+			}),
+		Option ('l', "length",
+			Option::RequiredArgument, "bytes",
+			"Buffer length used for the benchmark (default is 512, the size of a flash page).",
+			[&bench_length] (const char *optarg) -> bool {
+				char *endptr;
+				bench_length = strtoul (optarg, &endptr, 10);
+				return *optarg != '\0' && *endptr == '\0' &&
+					bench_length > 0 && bench_length <= MaxLength;
+			}),
+		Option ('b', "bench-size",
+			Option::RequiredArgument, "MiB",
+			"Data processed by each implementation in the benchmark, 0 disables it (default is 64).",
+			[&bench_total] (const char *optarg) -> bool {
+				char *endptr;
+				bench_total = strtoul (optarg, &endptr, 10) << 20;
+				return *optarg != '\0' && *endptr == '\0';
+			}),
+	};
+	Option help = HelpOption (argv[0], args, &options);
+	options.push_back (help);
+
+	int first_arg;
+	if (!Option::processOptions (argc, argv, options, first_arg))
+		return EXIT_FAILURE;
+
+	if (argc-first_arg != 0) {
+		fprintf (stderr, "%s", getUsage (argv[0], args, &options).c_str ());
+		return EXIT_FAILURE;
+	}
+
+	auto impls = CRC::implementations ();
+	printf ("Selected implementation: %s\n", CRC::implementationName ());
+
+	std::mt19937 rng (0x1021);
+	std::vector<uint8_t> buffer (MaxLength + MaxAlignment);
+	for (auto &byte: buffer)
+		byte = rng ();
+
+	// Compare every implementation with the reference on random slices
+	unsigned int failures = 0;
+	for (unsigned int i = 0; i < count; ++i) {
+		std::size_t offset = rng () % MaxAlignment;
+		// Favor short lengths around the SIMD thresholds
+		std::size_t length = rng () % (i % 2 ? MaxLength : 256);
+		uint16_t start = rng ();
+		const uint8_t *begin = buffer.data () + offset, *end = begin + length;
+		uint16_t expected = CRC::CCITTReference (begin, end, start);
+		for (const auto &impl: impls) {
+			uint16_t crc = impl.function (begin, end, start);
+			if (crc != expected) {
+				if (failures++ < 10)
+					fprintf (stderr, "%s: offset %zu, length %zu, start %04hx: got %04hx, expected %04hx\n",
+						 impl.name, offset, length, start, crc, expected);
+			}
+		}
+		if (i % 1000 == 0)
+			buffer[rng () % buffer.size ()] = rng ();
+	}
+	if (failures > 0) {
+		fprintf (stderr, "%u mismatches in %u buffers.\n", failures, count);
+		return EXIT_FAILURE;
+	}
+	printf ("%zu implementations matched the reference on %u buffers.\n", impls.size (), count);
+
+	if (bench_total == 0)
+		return EXIT_SUCCESS;
+	unsigned int iterations = std::max<std::size_t> (1, bench_total / bench_length);
+	for (const auto &impl: impls) {
+		uint16_t crc = 0xFFFF;
+		auto start = std::chrono::steady_clock::now ();
+		for (unsigned int i = 0; i < iterations; ++i)
+			crc = impl.function (buffer.data (), buffer.data () + bench_length, crc);
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now () - start;
+		printf ("%-12s %10.1f MiB/s (%zu bytes buffers, crc %04hx)\n", impl.name,
+			iterations * bench_length / elapsed.count () / (1 << 20),
+			bench_length, crc);
+	}
+
+	return EXIT_SUCCESS;
+}
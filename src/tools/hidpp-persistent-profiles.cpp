@@ -31,6 +31,9 @@
 #include <hidpp20/MemoryMapping.h>
 #include <hidpp10/MacroFormat.h>
 #include <hidpp20/MacroFormat.h>
+#include <hidpp/ProfilePrefetch.h>
+#include <hidpp/MacroLayout.h>
+#include <hidpp/ProfileBundle.h>
 #include <hidpp10/DeviceInfo.h>
 #include <misc/Log.h>
 
@@ -45,12 +48,20 @@ using namespace tinyxml2;
 
 int main (int argc, char *argv[])
 {
-	static const char *args = "device_path read|write [file]";
+	static const char *args = "device_path read|write [file] | compile bundle [file] | deploy bundle";
 	HIDPP::DeviceIndex device_index = HIDPP::DefaultDevice;
+	bool optimize_macros = false;
+	bool verify = false;
+	unsigned int read_window = HIDPP::AbstractMemoryMapping::DefaultReadWindow;
+	unsigned int write_window = HIDPP::AbstractMemoryMapping::DefaultWriteWindow;
 
 	std::vector<Option> options = {
 		DeviceIndexOption (device_index),
 		VerboseOption (),
+		OptimizeMacrosOption (optimize_macros),
+		VerifyOption (verify),
+		ReadWindowOption (read_window),
+		WriteWindowOption (write_window),
 	};
 	Option help = HelpOption (argv[0], args, &options);
 	options.push_back (help);
@@ -59,7 +70,7 @@ int main (int argc, char *argv[])
 	if (!Option::processOptions (argc, argv, options, first_arg))
 		return EXIT_FAILURE;
 
-	if (argc-first_arg < 2 || argc-first_arg > 3) {
+	if (argc-first_arg < 2 || argc-first_arg > 4) {
 		fprintf (stderr, "%s", getUsage (argv[0], args, &options).c_str ());
 		return EXIT_FAILURE;
 	}
@@ -67,6 +78,14 @@ int main (int argc, char *argv[])
 	const char *path = argv[first_arg];
 	std::string op = argv[first_arg+1];
 
+	// Bundle operations have one more argument
+	int max_args = op == "compile" ? 4 : 3;
+	int min_args = op == "compile" || op == "deploy" ? 3 : 2;
+	if (argc-first_arg < min_args || argc-first_arg > max_args) {
+		fprintf (stderr, "%s", getUsage (argv[0], args, &options).c_str ());
+		return EXIT_FAILURE;
+	}
+
 	std::unique_ptr<HIDPP::Dispatcher> dispatcher;
 	try {
 		dispatcher = std::make_unique<HIDPP::SimpleDispatcher> (path);
@@ -86,6 +105,7 @@ int main (int argc, char *argv[])
 	std::unique_ptr<HIDPP::AbstractMemoryMapping> memory;
 	std::unique_ptr<HIDPP::AbstractMacroFormat> macro_format;
 	HIDPP::Address dir_address, prof_address;
+	HIDPP::ProfileBundle::Target target;
 
 	/*
 	 * HID++ 1.0
@@ -100,6 +120,8 @@ int main (int argc, char *argv[])
 		memory.reset (new HIDPP10::MemoryMapping (dev));
 		dir_address = HIDPP::Address { 0, 1, 0 };
 		prof_address = HIDPP::Address { 0, info->default_profile_page, 0 };
+		// Formats only depend on the model
+		target = { 1, dev->productID (), 0, 0, 0 };
 	}
 	/*
 	 * HID++ 2.0 and later
@@ -113,21 +135,33 @@ int main (int argc, char *argv[])
 		memory.reset (new HIDPP20::MemoryMapping (dev));
 		dir_address = HIDPP::Address { HIDPP20::IOnboardProfiles::Writeable, 0, 0 };
 		prof_address = HIDPP::Address { HIDPP20::IOnboardProfiles::Writeable, 1, 0 };
+		auto desc = HIDPP20::IOnboardProfiles (dev).getDescription ();
+		target = { 2, dev->productID (), desc.profile_format, desc.macro_format, 0 };
 	}
 	else {
 		fprintf (stderr, "Unsupported HID++ protocol version.\n");
 		return EXIT_FAILURE;
 	}
 
+	memory->setReadWindow (read_window);
+	memory->setWriteWindow (write_window);
+
 	ProfileXML profxml (profile_format.get (), profdir_format.get ());
 
-	if (op == "write") {
+	/*
+	 * Encode the profiles from the XML in \p filename (or stdin) in the
+	 * memory pages, \p pages receives the address of every written page.
+	 * With \p commit, pages are written to the device as soon as they are
+	 * final.
+	 */
+	auto encodeProfiles = [&] (const char *filename, bool commit,
+				   std::vector<HIDPP::Address> &pages) -> bool {
 		// Read XML input
 		std::string xml;
 		std::ifstream file;
 		std::istream *input;
-		if (argc-first_arg == 3) {
-			file.open (argv[first_arg+2]);
+		if (filename) {
+			file.open (filename);
 			input = &file;
 		}
 		else {
@@ -144,7 +178,7 @@ int main (int argc, char *argv[])
 		doc.Parse (xml.c_str ());
 		if (doc.Error ()) {
 			fprintf (stderr, "Error parsing XML:\n%s\n", doc.ErrorStr ());
-			return EXIT_FAILURE;
+			return false;
 		}
 
 		HIDPP::ProfileDirectory profdir;
@@ -169,40 +203,80 @@ int main (int argc, char *argv[])
 			++prof_address.page;
 		}
 
-		// Macro are written from the next page after profiles
-		HIDPP::Address macro_address = prof_address;
+		// Macros are packed in the pages after profiles
+		HIDPP::MacroLayout macro_layout (*macro_format, *memory);
+		std::vector<std::vector<std::size_t>> macro_indexes (profiles.size ());
+		for (unsigned int i = 0; i < profiles.size (); ++i) {
+			const auto &profile = profiles[i];
+			for (unsigned int j = 0; j < profile.buttons.size (); ++j) {
+				if (profile.buttons[j].type () == HIDPP::Profile::Button::Type::Macro) {
+					if (optimize_macros) {
+						std::size_t size = macros[i][j].size ();
+						macros[i][j].optimize (*macro_format);
+						Log::info ().printf ("Optimized macro for profile %u button %u: %zu items to %zu.\n",
+								     i, j, size, macros[i][j].size ());
+					}
+					macro_indexes[i].push_back (macro_layout.add (macros[i][j]));
+				}
+				else
+					macro_indexes[i].push_back (0);
+			}
+		}
+		macro_layout.write (prof_address);
+		for (const auto &page: macro_layout.pages ()) {
+			if (commit)
+				memory->commitPage (page);
+			pages.push_back (page);
+		}
+		Log::info ().printf ("Stored %zu macros in %zu pages.\n",
+				     macro_layout.storedCount (),
+				     macro_layout.pages ().size ());
+
 		for (unsigned int i = 0; i < profiles.size (); ++i) {
 			auto &entry = profdir.entries[i];
 			auto &profile = profiles[i];
 			for (unsigned int j = 0; j < profile.buttons.size (); ++j) {
 				auto &button = profile.buttons[j];
-				if (button.type () == HIDPP::Profile::Button::Type::Macro) {
-					auto &macro = macros[i][j];
-					auto next_address = macro.write (*macro_format, *memory, macro_address);
-					button.setMacro (macro_address);
-					macro_address = next_address;
-				}
+				if (button.type () == HIDPP::Profile::Button::Type::Macro)
+					button.setMacro (macro_layout.address (macro_indexes[i][j]));
 			}
 			auto it = memory->getWritableIterator (entry.profile_address);
 			profile_format->write (profile, it);
+			if (commit)
+				memory->commitPage (entry.profile_address);
+			pages.push_back (entry.profile_address);
 		}
 		{
 			auto it = memory->getWritableIterator (dir_address);
 			profdir_format->write (profdir, it);
 		}
+		pages.push_back (dir_address);
+		return true;
+	};
 
-		memory->sync ();
+	if (op == "write") {
+		// Pages are transferred as soon as they are final
+		memory->setStreamingWrites (true);
+		std::vector<HIDPP::Address> pages;
+		if (!encodeProfiles (argc-first_arg == 3 ? argv[first_arg+2] : nullptr, true, pages))
+			return EXIT_FAILURE;
+		if (verify)
+			memory->syncVerified ();
+		else
+			memory->sync ();
 	}
 	else if (op == "read") {
 		XMLPrinter printer;
 		XMLDocument doc;
 		XMLElement *root = doc.NewElement ("profiles");
 
-		auto profdir_it = memory->getReadOnlyIterator (dir_address);
-		HIDPP::ProfileDirectory profdir = profdir_format->read (profdir_it);
-		for (const auto &entry: profdir.entries) {
-			auto it = memory->getReadOnlyIterator (entry.profile_address);
-			HIDPP::Profile profile = profile_format->read (it);
+		memory->setVerifyCRC (true);
+		std::vector<HIDPP::Profile> profiles;
+		HIDPP::ProfileDirectory profdir = HIDPP::prefetchProfiles (
+				*memory, *profdir_format, *profile_format, dir_address, profiles);
+		for (unsigned int i = 0; i < profdir.entries.size (); ++i) {
+			const auto &entry = profdir.entries[i];
+			const auto &profile = profiles[i];
 
 			std::vector<HIDPP::Macro> macros;
 			for (const auto &button: profile.buttons) {
@@ -221,6 +295,11 @@ int main (int argc, char *argv[])
 		doc.InsertEndChild (root);
 		doc.Print (&printer);
 
+		const auto &stats = memory->readStatistics ();
+		Log::info ().printf ("Read %u pages, %u CRC failures, %u recovered, %u lines read again.\n",
+				     stats.pages_read, stats.crc_failures,
+				     stats.recovered_pages, stats.lines_reread);
+
 		// Read XML input
 		std::ofstream file;
 		std::ostream *output;
@@ -234,6 +313,53 @@ int main (int argc, char *argv[])
 		*output << printer.CStr ();
 
 	}
+	else if (op == "compile") {
+		target.page_size = memory->getReadOnlyPage (dir_address).size ();
+
+		// Pages are only encoded, the device memory is not modified
+		std::vector<HIDPP::Address> pages;
+		if (!encodeProfiles (argc-first_arg == 4 ? argv[first_arg+3] : nullptr, false, pages))
+			return EXIT_FAILURE;
+
+		HIDPP::ProfileBundle bundle;
+		bundle.target = target;
+		bundle.dir_address = dir_address;
+		for (const auto &address: pages)
+			bundle.pages.push_back ({ address, memory->getFinalPage (address) });
+
+		std::ofstream file (argv[first_arg+2], std::ios::binary);
+		try {
+			bundle.save (file);
+		}
+		catch (std::exception &e) {
+			fprintf (stderr, "%s.\n", e.what ());
+			return EXIT_FAILURE;
+		}
+		Log::info ().printf ("Compiled %zu pages.\n", bundle.pages.size ());
+	}
+	else if (op == "deploy") {
+		target.page_size = memory->getReadOnlyPage (dir_address).size ();
+
+		HIDPP::ProfileBundle bundle;
+		std::ifstream file (argv[first_arg+2], std::ios::binary);
+		try {
+			bundle = HIDPP::ProfileBundle::load (file);
+		}
+		catch (std::exception &e) {
+			fprintf (stderr, "Failed to load bundle: %s.\n", e.what ());
+			return EXIT_FAILURE;
+		}
+		memory->setStreamingWrites (true);
+		unsigned int written;
+		try {
+			written = bundle.deploy (*memory, target, dir_address, verify);
+		}
+		catch (std::runtime_error &e) {
+			fprintf (stderr, "%s.\n", e.what ());
+			return EXIT_FAILURE;
+		}
+		Log::info ().printf ("Wrote %u of %zu pages.\n", written, bundle.pages.size ());
+	}
 	else {
 		fprintf (stderr, "Invalid operation.\n");
 		return EXIT_FAILURE;
@@ -0,0 +1,140 @@
+/*
+ * Copyright 2026 Clément Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+
+#include <hidpp10/ProfileFormatG9.h>
+#include <hidpp10/ProfileFormatG500.h>
+#include <hidpp10/ProfileFormatG700.h>
+#include <hidpp10/Sensor.h>
+#include <hidpp20/ProfileFormat.h>
+
+#include "common/common.h"
+#include "common/Option.h"
+#include "common/CommonOptions.h"
+
+using HIDPP::Profile;
+
+static
+std::unique_ptr<HIDPP::AbstractProfileFormat> makeFormat (const std::string &name)
+{
+	if (name == "g9")
+		return std::make_unique<HIDPP10::ProfileFormatG9> (HIDPP10::ListSensor::S6090);
+	if (name == "g500")
+		return std::make_unique<HIDPP10::ProfileFormatG500> (HIDPP10::RangeSensor::S9500);
+	if (name == "g700")
+		return std::make_unique<HIDPP10::ProfileFormatG700> (HIDPP10::RangeSensor::S9500);
+	if (name.compare (0, 8, "hidpp20-") == 0) {
+		HIDPP20::IOnboardProfiles::Description desc = {};
+		desc.profile_format = atoi (name.c_str () + 8);
+		desc.macro_format = 1;
+		desc.profile_count = 5;
+		desc.button_count = 11;
+		desc.sector_count = 16;
+		desc.sector_size = 255;
+		desc.mechanical_layout = 0x0a; // G-shift and DPI shift
+		desc.various_info = 0x02; // Wireless, with power modes
+		if (desc.profile_format < 1 || desc.profile_format > 3)
+			return nullptr;
+		return std::make_unique<HIDPP20::ProfileFormat> (desc);
+	}
+	return nullptr;
+}
+
+int main (int argc, char *argv[])
+{
+	static const char *args = "g9|g500|g700|hidpp20-1|hidpp20-2|hidpp20-3 [file]";
+	unsigned int count = 100000;
+
+	std::vector<Option> options = {
+		Option ('n', "count",
+			Option::RequiredArgument, "count",
+			"Number of profiles decoded and encoded (default is 100000).",
+			[&count] (const char *optarg) -> bool {
+				char *endptr;
+				count = strtoul (optarg, &endptr, 10);
+				return *optarg != '\0' && *endptr == '\0' && count > 0;
+			}),
+	};
+	Option help = HelpOption (argv[0], args, &options);
+	options.push_back (help);
+
+	int first_arg;
+	if (!Option::processOptions (argc, argv, options, first_arg))
+		return EXIT_FAILURE;
+
+	if (argc-first_arg < 1 || argc-first_arg > 2) {
+		fprintf (stderr, "%s", getUsage (argv[0], args, &options).c_str ());
+		return EXIT_FAILURE;
+	}
+
+	auto format = makeFormat (argv[first_arg]);
+	if (!format) {
+		fprintf (stderr, "Unknown profile format: %s\n", argv[first_arg]);
+		return EXIT_FAILURE;
+	}
+
+	std::vector<uint8_t> page (format->size ());
+	if (argc-first_arg == 2) {
+		// Raw profile data, e.g. from hidpp10-dump-page or hidpp20-dump-page
+		std::ifstream file (argv[first_arg+1], std::ios::binary);
+		file.read (reinterpret_cast<char *> (page.data ()), page.size ());
+		if (file.gcount () != static_cast<std::streamsize> (page.size ())) {
+			fprintf (stderr, "%s does not contain a whole profile.\n", argv[first_arg+1]);
+			return EXIT_FAILURE;
+		}
+	}
+	else {
+		// Default settings with every button and mode used
+		Profile profile;
+		profile.settings = HIDPP::SettingValues (format->generalSettings ().size ());
+		for (unsigned int i = 0; i < format->maxModeCount (); ++i)
+			profile.modes.emplace_back (format->modeSettings ().size ());
+		for (unsigned int i = 0; i < format->maxButtonCount (); ++i)
+			profile.buttons.emplace_back (Profile::Button::MouseButtonsType (), 1u << (i % 16));
+		format->write (profile, page.begin ());
+	}
+
+	typedef std::chrono::steady_clock clock;
+	Profile profile;
+	auto start = clock::now ();
+	for (unsigned int i = 0; i < count; ++i)
+		profile = format->read (page.begin ());
+	std::chrono::duration<double> decode_time = clock::now () - start;
+
+	std::vector<uint8_t> encoded (page.size ());
+	start = clock::now ();
+	for (unsigned int i = 0; i < count; ++i)
+		format->write (profile, encoded.begin ());
+	std::chrono::duration<double> encode_time = clock::now () - start;
+
+	printf ("%u profiles (%zu settings, %zu modes, %zu buttons)\n", count,
+		profile.settings.size (), profile.modes.size (), profile.buttons.size ());
+	printf ("decode: %8.3f us/profile\n", decode_time.count () * 1e6 / count);
+	printf ("encode: %8.3f us/profile\n", encode_time.count () * 1e6 / count);
+	auto diff = std::mismatch (page.begin (), page.end (), encoded.begin ());
+	if (diff.first != page.end ())
+		printf ("Warning: the encoded profile differs from the decoded data from byte %zu.\n",
+			static_cast<std::size_t> (diff.first - page.begin ()));
+
+	return EXIT_SUCCESS;
+}
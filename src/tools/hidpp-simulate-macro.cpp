@@ -0,0 +1,217 @@
+/*
+ * Copyright 2026 Clément Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cstdio>
+#include <iostream>
+#include <fstream>
+#include <memory>
+
+#include <hidpp/MacroInterpreter.h>
+#include <hidpp/FileMemoryMapping.h>
+#include <hidpp10/MacroFormat.h>
+#include <hidpp20/MacroFormat.h>
+#include <hid/UsageStrings.h>
+#include <misc/Log.h>
+
+#include "common/common.h"
+#include "common/Option.h"
+#include "common/CommonOptions.h"
+
+#include "profile/MacroText.h"
+
+using HIDPP::Macro;
+using HIDPP::MacroInterpreter;
+using HIDPP::FileMemoryMapping;
+
+static
+bool parseTime (const char *optarg, unsigned int &time)
+{
+	char *endptr;
+	unsigned long value = strtoul (optarg, &endptr, 10);
+	if (*optarg == '\0' || *endptr != '\0') {
+		fprintf (stderr, "Invalid time: %s\n", optarg);
+		return false;
+	}
+	time = value;
+	return true;
+}
+
+static
+std::string eventString (const MacroInterpreter::Event &event)
+{
+	switch (event.usage_page) {
+	case 0x01:
+		switch (event.usage) {
+		case 0x30: return "X " + std::to_string (event.value);
+		case 0x31: return "Y " + std::to_string (event.value);
+		case 0x38: return "Wheel " + std::to_string (event.value);
+		}
+		break;
+	case 0x07:
+		if (event.usage >= 0xe0 && event.usage < 0xe8)
+			return HID::modifierString (1 << (event.usage-0xe0)) + (event.value ? " press" : " release");
+		return HID::keyString (event.usage) + (event.value ? " press" : " release");
+	case 0x09:
+		return HID::buttonString (1 << (event.usage-1)) + (event.value ? " press" : " release");
+	case 0x0c:
+		if (event.usage == 0x0238)
+			return "HWheel " + std::to_string (event.value);
+		return HID::consumerControlString (event.usage) + (event.value ? " press" : " release");
+	}
+	char str[32];
+	snprintf (str, sizeof (str), "%04hx:%04hx %d", event.usage_page, event.usage, event.value);
+	return str;
+}
+
+int main (int argc, char *argv[])
+{
+	static const char *args = "[file]";
+	MacroInterpreter interpreter;
+	std::unique_ptr<HIDPP::AbstractMacroFormat> format;
+	FileMemoryMapping::OffsetUnit unit;
+	std::size_t page_size;
+
+	std::vector<Option> options = {
+		VerboseOption (),
+		Option ('r', "release",
+			Option::RequiredArgument, "time",
+			"Release the button after time milliseconds (default is 0).",
+			[&interpreter] (const char *optarg) -> bool {
+				unsigned int time;
+				if (!parseTime (optarg, time))
+					return false;
+				interpreter.setReleaseTime (time);
+				return true;
+			}),
+		Option ('t', "item-time",
+			Option::RequiredArgument, "time",
+			"Time in milliseconds for executing each item (default is 0).",
+			[&interpreter] (const char *optarg) -> bool {
+				unsigned int time;
+				if (!parseTime (optarg, time))
+					return false;
+				interpreter.setItemTime (time);
+				return true;
+			}),
+		Option ('f', "format",
+			Option::RequiredArgument, "10|20",
+			"Write the macro with the HID++ 1.0 or 2.0 macro format in a memory image and simulate the macro read back from it.",
+			[&] (const char *optarg) -> bool {
+				std::string version = optarg;
+				if (version == "10") {
+					format = std::make_unique<HIDPP10::MacroFormat> ();
+					unit = FileMemoryMapping::OffsetUnit::Word;
+					page_size = 512;
+				}
+				else if (version == "20") {
+					format = std::make_unique<HIDPP20::MacroFormat> ();
+					unit = FileMemoryMapping::OffsetUnit::Byte;
+					page_size = 256;
+				}
+				else {
+					fprintf (stderr, "Invalid format: %s\n", optarg);
+					return false;
+				}
+				return true;
+			}),
+	};
+	Option help = HelpOption (argv[0], args, &options);
+	options.push_back (help);
+
+	int first_arg;
+	if (!Option::processOptions (argc, argv, options, first_arg))
+		return EXIT_FAILURE;
+
+	if (argc-first_arg > 1) {
+		fprintf (stderr, "%s", getUsage (argv[0], args, &options).c_str ());
+		return EXIT_FAILURE;
+	}
+
+	// Read macro text input
+	std::string text;
+	std::ifstream file;
+	std::istream *input;
+	if (argc-first_arg == 1) {
+		file.open (argv[first_arg]);
+		if (!file) {
+			fprintf (stderr, "Failed to open %s.\n", argv[first_arg]);
+			return EXIT_FAILURE;
+		}
+		input = &file;
+	}
+	else {
+		input = &std::cin;
+	}
+	while (*input) {
+		char buffer[4096];
+		input->read (buffer, sizeof (buffer));
+		text.append (buffer, input->gcount ());
+	}
+
+	Macro macro;
+	try {
+		macro = textToMacro (text);
+	}
+	catch (std::exception &e) {
+		fprintf (stderr, "Invalid macro: %s.\n", e.what ());
+		return EXIT_FAILURE;
+	}
+	if (macro.size () == 0) {
+		fprintf (stderr, "Empty or invalid macro.\n");
+		return EXIT_FAILURE;
+	}
+
+	auto result = interpreter.run (macro);
+
+	if (format) {
+		// Round trip through the macro format
+		FileMemoryMapping memory (16, page_size, unit);
+		HIDPP::Address address = { 0, 0, 0 };
+		Macro decoded_macro;
+		try {
+			HIDPP::Address end = macro.write (*format, memory, address);
+			memory.sync ();
+			decoded_macro = Macro (*format, memory, address);
+			Log::info ().printf ("Macro encoded from page %u offset %u to page %u offset %u.\n",
+					     address.page, address.offset, end.page, end.offset);
+		}
+		catch (std::exception &e) {
+			fprintf (stderr, "Cannot encode the macro: %s.\n", e.what ());
+			return EXIT_FAILURE;
+		}
+		// The format may add padding and jump items, compare without item time
+		MacroInterpreter untimed = interpreter;
+		untimed.setItemTime (0);
+		auto expected = untimed.run (macro);
+		auto decoded = untimed.run (decoded_macro);
+		if (decoded.events != expected.events || decoded.duration != expected.duration) {
+			fprintf (stderr, "The decoded macro does not produce the same events:\n");
+			for (const auto &event: decoded.events)
+				printf ("%6u ms\t%s\n", event.time, eventString (event).c_str ());
+			return EXIT_FAILURE;
+		}
+	}
+	for (const auto &event: result.events)
+		printf ("%6u ms\t%s\n", event.time, eventString (event).c_str ());
+	printf ("Executed %u items in %u ms", result.item_count, result.duration);
+	if (!result.complete)
+		printf (" (stopped before the end of the macro)");
+	printf (".\n");
+
+	return EXIT_SUCCESS;
+}
@@ -29,6 +29,7 @@
 #include <hidpp10/ProfileFormat.h>
 #include <hidpp10/ProfileDirectoryFormat.h>
 #include <hidpp10/MacroFormat.h>
+#include <misc/Log.h>
 
 #include "common/common.h"
 #include "common/Option.h"
@@ -47,10 +48,22 @@ int main (int argc, char *argv[])
 {
 	static const char *args = "device_path [file]";
 	HIDPP::DeviceIndex device_index = HIDPP::DefaultDevice;
+	bool diff_writes = false;
+	bool optimize_macros = false;
+	unsigned int write_window = HIDPP::AbstractMemoryMapping::DefaultWriteWindow;
 
 	std::vector<Option> options = {
 		DeviceIndexOption (device_index),
 		VerboseOption (),
+		OptimizeMacrosOption (optimize_macros),
+		WriteWindowOption (write_window),
+		Option ('d', "diff",
+			Option::NoArgument, "",
+			"Only write the parts of the RAM that changed.",
+			[&diff_writes] (const char *optarg) -> bool {
+				diff_writes = true;
+				return true;
+			})
 	};
 	Option help = HelpOption (argv[0], args, &options);
 	options.push_back (help);
@@ -78,7 +91,8 @@ int main (int argc, char *argv[])
 	auto profile_format = getProfileFormat (&dev);
 	auto profdir_format = getProfileDirectoryFormat (&dev);
 	auto macro_format = getMacroFormat (&dev);
-	RAMMapping memory (&dev);
+	RAMMapping memory (&dev, diff_writes);
+	memory.setWriteWindow (write_window);
 
 	// Read XML input
 	std::string xml;
@@ -117,6 +131,12 @@ int main (int argc, char *argv[])
 			auto &button = profile.buttons[i];
 			if (button.type () == HIDPP::Profile::Button::Type::Macro) {
 				auto &macro = macros[i];
+				if (optimize_macros) {
+					std::size_t size = macro.size ();
+					macro.optimize (*macro_format);
+					Log::info ().printf ("Optimized macro for button %u: %zu items to %zu.\n",
+							     i, size, macro.size ());
+				}
 				auto next_address = macro.write (*macro_format, memory, macro_address);
 				button.setMacro (macro_address);
 				macro_address = next_address;
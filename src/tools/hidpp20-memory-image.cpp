@@ -0,0 +1,115 @@
+/*
+ * Copyright 2026 Clément Vuchener
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+
+#include <hidpp/SimpleDispatcher.h>
+#include <hidpp20/Device.h>
+#include <hidpp20/Error.h>
+#include <hidpp20/MemorySnapshot.h>
+
+#include "common/common.h"
+#include "common/Option.h"
+#include "common/CommonOptions.h"
+
+int main (int argc, char *argv[])
+{
+	static const char *args = "device_path save|restore file";
+	HIDPP::DeviceIndex device_index = HIDPP::DefaultDevice;
+	bool force = false;
+	bool verify = false;
+	unsigned int window = HIDPP::AbstractMemoryMapping::DefaultReadWindow;
+
+	std::vector<Option> options = {
+		DeviceIndexOption (device_index),
+		VerboseOption (),
+		ReadWindowOption (window),
+		VerifyOption (verify),
+		Option ('f', "force",
+			Option::NoArgument, "",
+			"Restore even if the image was taken from another device model",
+			[&force] (const char *) -> bool {
+				force = true;
+				return true;
+			}),
+	};
+	Option help = HelpOption (argv[0], args, &options);
+	options.push_back (help);
+
+	int first_arg;
+	if (!Option::processOptions (argc, argv, options, first_arg))
+		return EXIT_FAILURE;
+
+	if (argc-first_arg != 3) {
+		fprintf (stderr, "%s", getUsage (argv[0], args, &options).c_str ());
+		return EXIT_FAILURE;
+	}
+
+	const char *path = argv[first_arg];
+	std::string op = argv[first_arg+1];
+	const char *filename = argv[first_arg+2];
+
+	std::unique_ptr<HIDPP::Dispatcher> dispatcher;
+	try {
+		dispatcher = std::make_unique<HIDPP::SimpleDispatcher> (path);
+	}
+	catch (std::exception &e) {
+		fprintf (stderr, "Failed to open device: %s.\n", e.what ());
+		return EXIT_FAILURE;
+	}
+	HIDPP20::Device dev (dispatcher.get (), device_index);
+	try {
+		if (op == "save") {
+			auto snapshot = HIDPP20::MemorySnapshot::take (&dev, window);
+			std::ofstream file (filename, std::ios::binary);
+			snapshot.save (file);
+			printf ("Saved %zu sectors.\n", snapshot.sectors.size ());
+		}
+		else if (op == "restore") {
+			std::ifstream file (filename, std::ios::binary);
+			if (!file) {
+				fprintf (stderr, "Failed to open %s.\n", filename);
+				return EXIT_FAILURE;
+			}
+			auto snapshot = HIDPP20::MemorySnapshot::load (file);
+			if (!force && !snapshot.matches (&dev)) {
+				fprintf (stderr, "The image was taken from another device (%04hx:%04hx %s).\n",
+					 snapshot.vendor_id, snapshot.product_id, snapshot.name.c_str ());
+				return EXIT_FAILURE;
+			}
+			unsigned int written = snapshot.restore (&dev, window, verify);
+			printf ("Restored %u sectors.\n", written);
+		}
+		else {
+			fprintf (stderr, "Invalid operation: %s.\n", op.c_str ());
+			return EXIT_FAILURE;
+		}
+	}
+	catch (HIDPP20::Error &e) {
+		fprintf (stderr, "HID++2 error %d: %s\n", e.errorCode (), e.what ());
+		return e.errorCode ();
+	}
+	catch (std::exception &e) {
+		fprintf (stderr, "Error: %s.\n", e.what ());
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
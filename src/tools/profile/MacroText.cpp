@@ -43,17 +43,17 @@ std::string formatParam (std::string param)
 std::string macroToText (Macro::const_iterator begin, Macro::const_iterator end)
 {
 	unsigned int next_label = 0;
-	std::map<const Macro::Item *, std::string> labels;
+	std::map<std::size_t, std::string> labels;
 
 	for (auto it = begin; it != end; ++it) {
 		const Macro::Item &item = *it;
 		if (item.isJump ()) {
-			Macro::const_iterator dest = item.jumpDestination ();
-			if (labels.find (&(*dest)) != labels.end ())
+			std::size_t dest = item.jumpDestination ();
+			if (labels.find (dest) != labels.end ())
 				continue;
 			std::stringstream ss;
 			ss << "label" << next_label++;
-			labels.insert ({&(*dest), ss.str ()});
+			labels.insert ({dest, ss.str ()});
 		}
 	}
 
@@ -61,7 +61,7 @@ std::string macroToText (Macro::const_iterator begin, Macro::const_iterator end)
 
 	for (auto it = begin; it != end; ++it) {
 		const Macro::Item &item = *it;
-		auto label = labels.find (&item);
+		auto label = labels.find (std::distance (begin, it));
 		if (label != labels.end ()) {
 			ss << label->second << ":" << std::endl;
 		}
@@ -108,7 +108,7 @@ std::string macroToText (Macro::const_iterator begin, Macro::const_iterator end)
 
 		case Macro::Item::Jump:
 		case Macro::Item::JumpIfPressed:
-			ss << " " << labels[&(*item.jumpDestination ())];
+			ss << " " << labels[item.jumpDestination ()];
 			break;
 
 		case Macro::Item::MousePointer:
@@ -117,7 +117,7 @@ std::string macroToText (Macro::const_iterator begin, Macro::const_iterator end)
 
 		case Macro::Item::JumpIfReleased:
 			ss << " " << item.delay ()
-			   << " " << labels[&(*item.jumpDestination ())];
+			   << " " << labels[item.jumpDestination ()];
 			break;
 
 		default:
@@ -147,8 +147,8 @@ Macro textToMacro (const std::string &text)
 	static const std::regex LabeledInstructionRegex ("(?:(\\w+):)?\\s*(\\w+)");
 	static const std::regex ParamRegex ("(;)|\"([^\"]*)\"|([^[:space:];]+)");
 
-	std::map<std::string, Macro::iterator> labels;
-	std::vector<std::pair<Macro::Item *, std::string>> jumps;
+	std::map<std::string, std::size_t> labels;
+	std::vector<std::pair<std::size_t, std::string>> jumps;
 
 	Macro macro;
 
@@ -249,7 +249,7 @@ Macro textToMacro (const std::string &text)
 		}
 		case Macro::Item::Jump:
 		case Macro::Item::JumpIfPressed:
-			jumps.emplace_back (item, params[0]);
+			jumps.emplace_back (macro.size ()-1, params[0]);
 			break;
 		case Macro::Item::MousePointer: {
 			int x = std::stoi (params[0]);
@@ -261,7 +261,7 @@ Macro textToMacro (const std::string &text)
 		case Macro::Item::JumpIfReleased: {
 			unsigned int delay = std::stoul (params[0]);
 			item->setDelay (delay);
-			jumps.emplace_back (item, params[1]);
+			jumps.emplace_back (macro.size ()-1, params[1]);
 			break;
 		}
 		default:
@@ -269,19 +269,19 @@ Macro textToMacro (const std::string &text)
 		}
 
 		if (!label.empty ()) {
-			labels.emplace (label, std::prev (macro.end ()));
+			labels.emplace (label, macro.size ()-1);
 		}
 	}
 
 	for (auto pair: jumps) {
-		Macro::Item *item = pair.first;
+		Macro::Item &item = macro[pair.first];
 		const std::string &label = pair.second;
 		auto it = labels.find (label);
 		if (it == labels.end ()) {
 			Log::error () << "Unknown label " << label << std::endl;
 			return Macro ();
 		}
-		item->setJumpDestination (it->second);
+		item.setJumpDestination (it->second);
 	}
 
 	return macro;
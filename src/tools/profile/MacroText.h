@@ -22,6 +22,10 @@
 #include <hidpp/Macro.h>
 #include <string>
 
+/**
+ * Jump destinations are item indexes relative to \p begin, ranges
+ * containing jumps must start at the beginning of their macro.
+ */
 std::string macroToText (HIDPP::Macro::const_iterator begin,
 			 HIDPP::Macro::const_iterator end);
 
@@ -139,13 +139,15 @@ void insertButton (const Profile::Button &button, const Macro &macro, XMLNode *p
 }
 
 static
-void insertSetting (const std::string &name, const Setting &value, XMLNode *parent)
+void insertSettings (const SettingValues &values, const SettingSchema &schema, XMLNode *parent);
+
+static
+void insertSetting (const char *name, const Setting &value, const SettingDesc &desc, XMLNode *parent)
 {
 	XMLDocument *doc = parent->GetDocument ();
-	XMLElement *element = doc->NewElement (name.c_str ());
+	XMLElement *element = doc->NewElement (name);
 	if (value.type () == Setting::Type::ComposedSetting) {
-		for (const auto &p: value.get<ComposedSetting> ())
-			insertSetting (p.first, p.second, element);
+		insertSettings (value.get<ComposedSetting> (), desc.subSettings (), element);
 	}
 	else {
 		try {
@@ -159,24 +161,31 @@ void insertSetting (const std::string &name, const Setting &value, XMLNode *pare
 	parent->InsertEndChild (element);
 }
 
+static
+void insertSettings (const SettingValues &values, const SettingSchema &schema, XMLNode *parent)
+{
+	for (std::size_t i = 0; i < schema.size (); ++i) {
+		const Setting *value = values.find (i);
+		if (value && schema.available (i))
+			insertSetting (schema[i].name, *value, schema[i].desc, parent);
+	}
+}
+
 void ProfileXML::write (const Profile &profile, const ProfileDirectory::Entry &entry, const std::vector<Macro> &macros, XMLNode *node)
 {
 	XMLDocument *doc = node->GetDocument ();
 
-	for (const auto &p: entry.settings)
-		insertSetting (p.first, p.second, node);
+	insertSettings (entry.settings, _entry_settings, node);
 
 	XMLElement *modes = doc->NewElement ("modes");
 	for (const auto &mode: profile.modes) {
 		XMLElement *mode_el = doc->NewElement ("mode");
-		for (const auto &p: mode)
-			insertSetting (p.first, p.second, mode_el);
+		insertSettings (mode, _mode_settings, mode_el);
 		modes->InsertEndChild (mode_el);
 	}
 	node->InsertEndChild (modes);
 
-	for (const auto &p: profile.settings)
-		insertSetting (p.first, p.second, node);
+	insertSettings (profile.settings, _profile_settings, node);
 
 	XMLElement *buttons = doc->NewElement ("buttons");
 	for (unsigned int i = 0; i < profile.buttons.size (); ++i) {
@@ -277,18 +286,19 @@ static
 Setting readSetting (const XMLElement *element, const SettingDesc &desc)
 {
 	if (desc.isComposed ()) {
-		ComposedSetting settings;
+		const SettingSchema &sub_settings = desc.subSettings ();
+		ComposedSetting settings (sub_settings.size ());
 
 		const XMLElement *child = element->FirstChildElement ();
 		while (child) {
 			std::string name = child->Name ();
-			auto it = desc.find (name);
-			if (it == desc.end ()) {
+			std::size_t index = sub_settings.find (name);
+			if (index == SettingSchema::npos) {
 				Log::warning () << "Ignoring invalid sub-setting: "
 						<< name << std::endl;
 			}
 			else {
-				settings.emplace (name, readSetting (child, it->second));
+				settings.set (index, readSetting (child, sub_settings[index].desc));
 			}
 			child = child->NextSiblingElement ();
 		}
@@ -308,19 +318,19 @@ void ProfileXML::read (const XMLNode *node, Profile &profile, ProfileDirectory::
 		if (name == "modes") {
 			const XMLElement *mode_el = element->FirstChildElement ("mode");
 			while (mode_el) {
-				profile.modes.emplace_back ();
+				profile.modes.emplace_back (_mode_settings.size ());
 				auto &current_mode = profile.modes.back ();
 
 				const XMLElement *setting = mode_el->FirstChildElement ();
 				while (setting) {
 					std::string sname = setting->Name ();
-					auto it = _mode_settings.find (sname);
-					if (it == _mode_settings.end ()) {
+					std::size_t index = _mode_settings.find (sname);
+					if (index == SettingSchema::npos) {
 						Log::warning () << "Ignoring invalid mode setting: "
 								<< sname << std::endl;
 					}
 					else {
-						current_mode.emplace (sname, readSetting (setting, it->second));
+						current_mode.set (index, readSetting (setting, _mode_settings[index].desc));
 					}
 					setting = setting->NextSiblingElement ();
 				}
@@ -339,12 +349,12 @@ void ProfileXML::read (const XMLNode *node, Profile &profile, ProfileDirectory::
 			}
 		}
 		else {
-			auto it = _entry_settings.find (name);
-			if (it != _entry_settings.end ()) {
-				entry.settings.emplace (name, readSetting (element, it->second));
+			std::size_t index;
+			if ((index = _entry_settings.find (name)) != SettingSchema::npos) {
+				entry.settings.set (index, readSetting (element, _entry_settings[index].desc));
 			}
-			else if ((it = _profile_settings.find (name)) != _profile_settings.end ()) {
-				profile.settings.emplace (name, readSetting (element, it->second));
+			else if ((index = _profile_settings.find (name)) != SettingSchema::npos) {
+				profile.settings.set (index, readSetting (element, _profile_settings[index].desc));
 			}
 			else {
 				Log::warning () << "Ignoring invalid setting: "
@@ -44,9 +44,9 @@ public:
 		   std::vector<HIDPP::Macro> &macros);
 
 private:
-	const std::map<std::string, HIDPP::SettingDesc> &_profile_settings;
-	const std::map<std::string, HIDPP::SettingDesc> &_mode_settings;
-	const std::map<std::string, HIDPP::SettingDesc> &_entry_settings;
+	HIDPP::SettingSchema _profile_settings;
+	HIDPP::SettingSchema _mode_settings;
+	HIDPP::SettingSchema _entry_settings;
 	const HIDPP::EnumDesc &_special_actions;
 };
 